@@ -0,0 +1,207 @@
+//
+//  accept_engine.hpp
+//  bacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bacs.hpp"
+#include "socket_profile.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace bacs
+{
+    struct accept_config
+    {
+        /// @brief Accepts kept outstanding on every acceptor, so a burst of connections doesn't wait for each handler in turn.
+        std::size_t accepts_in_flight = 4;
+
+        /// @brief Open one SO_REUSEPORT acceptor per target executor instead of a single shared one. Each then accepts on its
+        /// own thread and the kernel spreads incoming connections between them. Ignored where SO_REUSEPORT is unavailable.
+        bool reuse_port = false;
+
+        int backlog = boost::asio::socket_base::max_listen_connections;
+
+        /// @brief Applied to every accepted socket before it's handed over. Options the socket refuses are skipped.
+        std::optional<socket_profile> profile;
+
+        /// @brief How long an accept waits before retrying after failing for lack of descriptors, buffers or memory.
+        /// Retrying straight away would only fail again and keep the thread spinning until something is freed.
+        std::chrono::milliseconds exhausted_backoff{ 50 };
+    };
+
+    /// @brief Listens on an endpoint with several accepts in flight and hands every accepted socket over by move,
+    /// already bound to one of the target executors (e.g. one io_context per core), picked round-robin.
+    /// The handler may be called concurrently from the targets' threads.
+    template<class Protocol>
+    class accept_engine
+    {
+    public:
+        using acceptor_type = typename Protocol::acceptor;
+        using socket_type = typename Protocol::socket;
+        using endpoint_type = typename Protocol::endpoint;
+        using executor_type = typename socket_type::executor_type;
+
+        /// @brief Called with every accepted socket; socket.get_executor() is the target it was accepted onto.
+        /// Failed accepts are reported with an empty socket and retried, except once the engine is closed.
+        /// Running out of resources is retried after accept_config::exhausted_backoff.
+        using handler_type = unique_function<void(const boost::system::error_code&, socket_type&&)>;
+
+        accept_engine(std::vector<executor_type> targets, const endpoint_type& endpoint, handler_type handler, accept_config config = {})
+        : _state(std::make_shared<state>(std::move(targets), std::move(handler), std::move(config.profile)))
+        {
+            if (_state->targets.empty())
+                throw std::runtime_error("bacs::accept_engine: no target executors");
+
+#if !defined(SO_REUSEPORT)
+            config.reuse_port = false;
+#endif
+            auto num_acceptors = config.reuse_port ? _state->targets.size() : 1;
+            auto bind_endpoint = endpoint;
+
+            for (std::size_t i = 0; i < num_acceptors; i++)
+            {
+                // Accepts complete on whichever of the target's threads is free, so each acceptor gets a strand of its own
+                auto& acceptor = _state->acceptors.emplace_back(executor_type(boost::asio::make_strand(_state->targets[i])));
+                acceptor.open(bind_endpoint.protocol());
+                acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+#if defined(SO_REUSEPORT)
+                if (config.reuse_port)
+                    acceptor.set_option(reuse_port(true));
+#endif
+                acceptor.bind(bind_endpoint);
+                acceptor.listen(config.backlog);
+
+                // Pin the rest of the acceptors to whatever port the first one actually got
+                bind_endpoint = acceptor.local_endpoint();
+            }
+
+            // The acceptors belong to their strands from here on
+            _endpoint = bind_endpoint;
+            _state->exhausted_backoff = config.exhausted_backoff;
+
+            auto in_flight = std::max<std::size_t>(config.accepts_in_flight, 1);
+
+            for (std::size_t i = 0; i < _state->acceptors.size(); i++)
+            {
+                boost::asio::post(_state->acceptors[i].get_executor(), [state = _state, i, in_flight]
+                    {
+                        for (std::size_t n = 0; n < in_flight; n++)
+                            accept(state, i);
+                    });
+            }
+        }
+
+        accept_engine(const accept_engine&) = delete;
+        accept_engine(accept_engine&&) = default;
+
+        ~accept_engine()
+        {
+            close();
+        }
+
+        endpoint_type local_endpoint() const
+        {
+            return _endpoint;
+        }
+
+        std::size_t num_acceptors() const
+        {
+            return _state->acceptors.size();
+        }
+
+        /// @brief Stops accepting. Outstanding accepts complete with operation_aborted and aren't reported.
+        void close()
+        {
+            if (!_state || _state->closed.exchange(true))
+                return;
+
+            for (std::size_t i = 0; i < _state->acceptors.size(); i++)
+            {
+                // Acceptors are only ever touched on their strands
+                boost::asio::post(_state->acceptors[i].get_executor(), [state = _state, i]
+                    {
+                        boost::system::error_code ec;
+                        state->acceptors[i].close(ec);
+                    });
+            }
+        }
+
+    private:
+        struct state
+        {
+            std::vector<executor_type> targets;
+            handler_type handler;
+            std::optional<socket_profile> profile;
+
+            // With reuse_port, acceptors[i] belongs to targets[i]
+            std::vector<acceptor_type> acceptors;
+            std::atomic<std::size_t> next_target = 0;
+            std::atomic<bool> closed = false;
+            std::chrono::milliseconds exhausted_backoff{ 0 };
+
+            state(std::vector<executor_type> rvtargets, handler_type rvhandler, std::optional<socket_profile> rvprofile)
+            : targets(std::move(rvtargets)), handler(std::move(rvhandler)), profile(std::move(rvprofile))
+            {
+                acceptors.reserve(targets.size());
+            }
+
+            const executor_type& pick_target()
+            {
+                return targets[next_target.fetch_add(1, std::memory_order_relaxed) % targets.size()];
+            }
+        };
+
+        static void accept(const std::shared_ptr<state>& state, std::size_t index)
+        {
+            // With one acceptor per target, sockets stay on the context that accepted them
+            auto& target = state->acceptors.size() > 1 ? state->targets[index] : state->pick_target();
+
+            state->acceptors[index].async_accept(target,
+                [state, index](const boost::system::error_code& ec, socket_type socket)
+                {
+                    if (state->closed || ec == boost::asio::error::operation_aborted || ec == boost::asio::error::bad_descriptor)
+                        return;
+
+                    // Re-arm first so the next connection isn't kept waiting on this one's handler
+                    if (is_exhaustion(ec))
+                        accept_later(state, index);
+                    else
+                        accept(state, index);
+
+                    if (!ec && state->profile)
+                        apply_socket_profile(socket, *state->profile);
+
+                    if (state->handler)
+                        state->handler(ec, std::move(socket));
+                });
+        }
+
+        static bool is_exhaustion(const boost::system::error_code& ec)
+        {
+            return ec == boost::asio::error::no_descriptors || ec == boost::system::errc::too_many_files_open_in_system ||
+                   ec == boost::asio::error::no_buffer_space || ec == boost::asio::error::no_memory;
+        }
+
+        static void accept_later(const std::shared_ptr<state>& state, std::size_t index)
+        {
+            auto timer = std::make_shared<boost::asio::steady_timer>(state->acceptors[index].get_executor(), state->exhausted_backoff);
+
+            timer->async_wait([state, index, timer](const boost::system::error_code&)
+                {
+                    if (!state->closed)
+                        accept(state, index);
+                });
+        }
+
+        std::shared_ptr<state> _state;
+        endpoint_type _endpoint;
+    };
+}
@@ -7,9 +7,17 @@
 //
 
 #pragma once
+// Boost 1.74's awaitable.hpp uses std::exchange without including <utility>, which breaks C++20 builds
+#include <utility>
 #include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <thread>
-#include <utility>
+#include <vector>
+
+#include "handler_memory.hpp"
+#include "unique_function.hpp"
 
 #ifndef BACS_CONFIG_HOSTNAME
 #define BACS_CONFIG_HOSTNAME "127.0.0.1"
@@ -23,6 +31,11 @@ namespace bacs
 {
     constexpr auto NetHostName = BACS_CONFIG_HOSTNAME;
     constexpr auto NetHostPort = BACS_CONFIG_HOSTPORT;
+
+#if defined(SO_REUSEPORT)
+    /// @brief SO_REUSEPORT as an asio socket option: lets several sockets bind the same port with the kernel balancing flows between them.
+    using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
     
     /// @brief Encapsules an IO context's run loop thread.
     template<class IOContext>
@@ -93,13 +106,24 @@ namespace bacs
     class shared_buffer
     {
     public:
+        shared_buffer()
+        : _size(0)
+        {}
+        
         shared_buffer(std::size_t size)
-        : _data(new char[size]), _size(size)
+        : _data(new char[size], std::default_delete<char[]>()), _size(size)
+        {}
+        
+        shared_buffer(std::shared_ptr<void> data, std::size_t size)
+        : _data(std::move(data)), _size(size)
         {}
         
         shared_buffer(const shared_buffer&) = default;
         shared_buffer(shared_buffer&&) = default;
         
+        shared_buffer& operator=(const shared_buffer&) = default;
+        shared_buffer& operator=(shared_buffer&&) = default;
+        
         void* data()
         {
             return _data.get();
@@ -135,10 +159,234 @@ namespace bacs
             return begin() + _size;
         }
         
+        long use_count() const
+        {
+            return _data.use_count();
+        }
+        
+        /// @brief Returns a view into a part of this buffer which shares ownership of the whole allocation.
+        shared_buffer slice(std::size_t offset, std::size_t size) const
+        {
+            return shared_buffer(std::shared_ptr<void>(_data, (char*) _data.get() + offset), size);
+        }
+        
     private:
         std::shared_ptr<void> _data;
         std::size_t _size;
     };
+    
+    /// @brief A thread-safe pool of equally sized shared_buffers.
+    /// A buffer returns to the pool by itself once every copy handed out by acquire() has been dropped, and so does the
+    /// shared_ptr control block that tracked it, so a pool that has seen its peak load stops touching the global heap.
+    /// At most max_free buffers are kept for reuse; whatever comes back past that goes back to the heap.
+    /// Buffers may outlive the pool.
+    class buffer_pool
+    {
+    public:
+        static constexpr std::size_t default_max_free = 256;
+
+        buffer_pool(std::size_t buffer_size, std::size_t max_free = default_max_free)
+        : _state(std::make_shared<state>(buffer_size, max_free))
+        {}
+        
+        buffer_pool(const buffer_pool&) = delete;
+        buffer_pool(buffer_pool&&) = delete;
+        
+        shared_buffer acquire()
+        {
+            // Should the control block fail to allocate, the deleter still hands the data back
+            auto data = _state->take_data();
+            return shared_buffer(std::shared_ptr<void>(data, returner{ _state }, block_allocator<char>{ _state }), _state->buffer_size);
+        }
+
+        /// @brief A buffer of exactly size bytes: a slice of a pooled one when it fits, one of its own otherwise.
+        shared_buffer acquire(std::size_t size)
+        {
+            return size <= _state->buffer_size ? acquire().slice(0, size) : shared_buffer{ size };
+        }
+        
+        std::size_t buffer_size() const
+        {
+            return _state->buffer_size;
+        }
+
+        /// @brief How many returned buffers are waiting to be reused.
+        std::size_t free_count() const
+        {
+            std::lock_guard lg{ _state->lock };
+            return _state->free_data.size();
+        }
+
+        /// @brief Gives every buffer waiting to be reused back to the heap, e.g. after a burst.
+        void trim()
+        {
+            _state->trim();
+        }
+        
+    private:
+        struct state
+        {
+            std::size_t buffer_size;
+            std::size_t max_free;
+            std::size_t block_bytes = 0;
+
+            // Reserved up front, so returning something never allocates
+            std::vector<char*> free_data;
+            std::vector<void*> free_blocks;
+            mutable std::mutex lock;
+
+            state(std::size_t buffer_size, std::size_t max_free)
+            : buffer_size(buffer_size), max_free(max_free)
+            {
+                free_data.reserve(max_free);
+                free_blocks.reserve(max_free);
+            }
+
+            ~state()
+            {
+                trim();
+            }
+
+            char* take_data()
+            {
+                {
+                    std::lock_guard lg{ lock };
+
+                    if (!free_data.empty())
+                    {
+                        auto data = free_data.back();
+                        free_data.pop_back();
+                        return data;
+                    }
+                }
+
+                return new char[buffer_size];
+            }
+
+            void give_data(char* data) noexcept
+            {
+                {
+                    std::lock_guard lg{ lock };
+
+                    if (free_data.size() < max_free)
+                    {
+                        free_data.push_back(data);
+                        return;
+                    }
+                }
+
+                delete[] data;
+            }
+
+            // Control blocks all have the same type and so the same size; anything else just goes to the heap
+            void* take_block(std::size_t bytes)
+            {
+                {
+                    std::lock_guard lg{ lock };
+
+                    if (bytes == block_bytes && !free_blocks.empty())
+                    {
+                        auto block = free_blocks.back();
+                        free_blocks.pop_back();
+                        return block;
+                    }
+                }
+
+                return ::operator new(bytes);
+            }
+
+            void give_block(void* block, std::size_t bytes) noexcept
+            {
+                {
+                    std::lock_guard lg{ lock };
+
+                    if (!block_bytes)
+                        block_bytes = bytes;
+
+                    if (bytes == block_bytes && free_blocks.size() < max_free)
+                    {
+                        free_blocks.push_back(block);
+                        return;
+                    }
+                }
+
+                ::operator delete(block, bytes);
+            }
+
+            void trim()
+            {
+                std::vector<char*> data;
+                std::vector<void*> blocks;
+
+                {
+                    std::lock_guard lg{ lock };
+                    data.swap(free_data);
+                    blocks.swap(free_blocks);
+
+                    free_data.reserve(max_free);
+                    free_blocks.reserve(max_free);
+                }
+
+                for (auto pointer : data)
+                    delete[] pointer;
+
+                for (auto pointer : blocks)
+                    ::operator delete(pointer, block_bytes);
+            }
+        };
+
+        struct returner
+        {
+            std::shared_ptr<state> pool;
+
+            void operator()(void* data) const noexcept
+            {
+                pool->give_data(static_cast<char*>(data));
+            }
+        };
+
+        // Owns a reference too: the control block is freed after the deleter inside it is already gone
+        template<class T>
+        struct block_allocator
+        {
+            using value_type = T;
+
+            std::shared_ptr<state> pool;
+
+            block_allocator(std::shared_ptr<state> pool) noexcept
+            : pool(std::move(pool))
+            {}
+
+            template<class U>
+            block_allocator(const block_allocator<U>& other) noexcept
+            : pool(other.pool)
+            {}
+
+            T* allocate(std::size_t n)
+            {
+                return static_cast<T*>(pool->take_block(sizeof(T) * n));
+            }
+
+            void deallocate(T* pointer, std::size_t n) noexcept
+            {
+                pool->give_block(pointer, sizeof(T) * n);
+            }
+
+            template<class U>
+            bool operator==(const block_allocator<U>& other) const noexcept
+            {
+                return pool == other.pool;
+            }
+
+            template<class U>
+            bool operator!=(const block_allocator<U>& other) const noexcept
+            {
+                return pool != other.pool;
+            }
+        };
+
+        std::shared_ptr<state> _state;
+    };
 
     struct sp_default
     {
@@ -159,12 +407,15 @@ namespace bacs
         auto size = (size_type)(std::size(container) * sizeof(*std::data(container)));
         SPTraits::out(size);
 
-        auto pSize = std::make_shared<size_type>(size);
-        auto pContainer = std::make_shared<Container>(container);
+        // Everything the write needs comes from the handler's associated allocator, same as asio's own operation storage
+        auto allocator = boost::asio::get_associated_allocator(handler);
+        auto pSize = std::allocate_shared<size_type>(allocator, size);
+        auto pContainer = std::allocate_shared<Container>(allocator, container);
         
         boost::asio::async_write(socket,
                                  boost::asio::const_buffer(pSize.get(), sizeof(*pSize)),
-                                 [&socket, pContainer, handler] (const boost::system::error_code& ec, std::size_t bytes_transferred)
+                                 bind_associated_allocator(allocator,
+                                 [&socket, pSize, pContainer, handler = std::forward<Handler>(handler)] (const boost::system::error_code& ec, std::size_t bytes_transferred) mutable
                                  {
                                      if(ec.failed())
                                      {
@@ -172,24 +423,56 @@ namespace bacs
                                          return;
                                      }
                                      
+                                     auto allocator = boost::asio::get_associated_allocator(handler);
+                                     
                                      boost::asio::async_write(socket,
                                                               boost::asio::const_buffer(std::data(*pContainer), std::size(*pContainer)),
-                                                              [handler](const boost::system::error_code& ec, std::size_t bytes_transferred)
+                                                              bind_associated_allocator(allocator,
+                                                              [pContainer, handler = std::move(handler)](const boost::system::error_code& ec, std::size_t bytes_transferred) mutable
                                                               {
                                                                   handler(ec, bytes_transferred);
-                                                              });
-                                 });
+                                                              }));
+                                 }));
     }
     
+    /// @brief Writes a shared_buffer with its size prefix in one gathered write, without copying it.
+    /// The buffer is kept alive until the write completes.
     template<class SPTraits = sp_default, class Socket, class Handler>
-    void async_read_sp(Socket& socket, Handler&& handler)
+    void async_write_sp(Socket& socket, shared_buffer buffer, Handler&& handler)
+    {
+        using size_type = typename SPTraits::size_type;
+
+        auto allocator = boost::asio::get_associated_allocator(handler);
+        auto pSize = std::allocate_shared<size_type>(allocator, (size_type)buffer.size());
+        SPTraits::out(*pSize);
+
+        std::array<boost::asio::const_buffer, 2> buffers
+        {
+            boost::asio::const_buffer(pSize.get(), sizeof(*pSize)),
+            boost::asio::const_buffer(buffer.data(), buffer.size())
+        };
+
+        boost::asio::async_write(socket, buffers,
+                                 bind_associated_allocator(allocator,
+                                 [pSize, buffer, handler = std::forward<Handler>(handler)] (const boost::system::error_code& ec, std::size_t bytes_transferred) mutable
+                                 {
+                                     // Only the payload counts, same as with the container overload
+                                     handler(ec, bytes_transferred > sizeof(size_type) ? bytes_transferred - sizeof(size_type) : 0);
+                                 }));
+    }
+    
+    /// @brief Reads a frame into the buffer make_buffer(size) returns for the frame's size.
+    template<class SPTraits = sp_default, class Socket, class MakeBuffer, class Handler>
+    void async_read_sp_into(Socket& socket, MakeBuffer make_buffer, Handler&& handler)
     {
         using size_type = typename SPTraits::size_type;
-        auto pSize = std::make_shared<size_type>();
+        auto allocator = boost::asio::get_associated_allocator(handler);
+        auto pSize = std::allocate_shared<size_type>(allocator);
         
         boost::asio::async_read(socket,
                                 boost::asio::mutable_buffer(pSize.get(), sizeof(*pSize)),
-                                [&socket, pSize, handler] (const boost::system::error_code& ec, std::size_t bytes_read)
+                                bind_associated_allocator(allocator,
+                                [&socket, pSize, make_buffer = std::move(make_buffer), handler = std::forward<Handler>(handler)] (const boost::system::error_code& ec, std::size_t bytes_read) mutable
                                 {
                                     if(ec.failed())
                                     {
@@ -197,51 +480,172 @@ namespace bacs
                                         return;
                                     }
                                     
+                                    shared_buffer buf;
+
                                     try
                                     {
                                         auto size = *pSize;
                                         SPTraits::in(size);
-                                        shared_buffer buf{ size };
-
-                                        boost::asio::async_read(socket,
-                                            boost::asio::mutable_buffer(buf.data(), buf.size()),
-                                            [buf, handler](const boost::system::error_code& ec, std::size_t bytes_read)
-                                            {
-                                                handler(ec, bytes_read, buf);
-                                            });
+                                        buf = make_buffer(size);
                                     }
                                     catch (...)
                                     {
-                                        handler(ec, bytes_read, shared_buffer{ 0 });
+                                        // The size came from the peer, so an allocation failure only fails this read
+                                        handler(boost::asio::error::no_memory, bytes_read, shared_buffer{ 0 });
                                         return;
                                     }
-                                });
+
+                                    auto allocator = boost::asio::get_associated_allocator(handler);
+                                    
+                                    // The handler is moved along instead of copied, so move-only handlers work and big captures cost nothing per frame
+                                    boost::asio::async_read(socket,
+                                        boost::asio::mutable_buffer(buf.data(), buf.size()),
+                                        bind_associated_allocator(allocator,
+                                        [buf, handler = std::move(handler)](const boost::system::error_code& ec, std::size_t bytes_read) mutable
+                                        {
+                                            handler(ec, bytes_read, buf);
+                                        }));
+                                }));
     }
     
     template<class SPTraits = sp_default, class Socket, class Handler>
-    void async_read_sp_loop(Socket& socket, Handler&& handler)
+    void async_read_sp(Socket& socket, Handler&& handler)
     {
-        async_read_sp<SPTraits>(socket,
-                      [&socket, handler](const boost::system::error_code& ec, std::size_t bytes_read, bacs::shared_buffer buffer)
+        async_read_sp_into<SPTraits>(socket, [](std::size_t size) { return shared_buffer{ size }; }, std::forward<Handler>(handler));
+    }
+
+    /// @brief Reads a frame into a buffer taken from the pool, handed out as a slice of the frame's size.
+    /// Frames bigger than the pool's buffers get one of their own. The pool has to outlive the read.
+    template<class SPTraits = sp_default, class Socket, class Handler>
+    void async_read_sp(Socket& socket, buffer_pool& pool, Handler&& handler)
+    {
+        async_read_sp_into<SPTraits>(socket, [&pool](std::size_t size) { return pool.acquire(size); }, std::forward<Handler>(handler));
+    }
+    
+    /// @brief Keeps reading frames into buffers from make_buffer(size) for as long as the handler returns true.
+    template<class SPTraits = sp_default, class Socket, class MakeBuffer, class Handler>
+    void async_read_sp_loop_into(Socket& socket, MakeBuffer make_buffer, Handler&& handler)
+    {
+        auto allocator = boost::asio::get_associated_allocator(handler);
+        
+        async_read_sp_into<SPTraits>(socket, make_buffer,
+                      bind_associated_allocator(allocator,
+                      [&socket, make_buffer, handler = std::forward<Handler>(handler)](const boost::system::error_code& ec, std::size_t bytes_read, bacs::shared_buffer buffer) mutable
                       {
                           if(handler(ec, bytes_read, buffer))
-                              async_read_sp_loop<SPTraits>(socket, handler);
+                              async_read_sp_loop_into<SPTraits>(socket, std::move(make_buffer), std::move(handler));
                       }
-                      );
+                      ));
+    }
+    
+    template<class SPTraits = sp_default, class Socket, class Handler>
+    void async_read_sp_loop(Socket& socket, Handler&& handler)
+    {
+        async_read_sp_loop_into<SPTraits>(socket, [](std::size_t size) { return shared_buffer{ size }; }, std::forward<Handler>(handler));
     }
     
+    /// @brief Same as above, reading into buffers from the pool like the pooled async_read_sp. The pool has to outlive the loop.
+    template<class SPTraits = sp_default, class Socket, class Handler>
+    void async_read_sp_loop(Socket& socket, buffer_pool& pool, Handler&& handler)
+    {
+        async_read_sp_loop_into<SPTraits>(socket, [&pool](std::size_t size) { return pool.acquire(size); }, std::forward<Handler>(handler));
+    }
+    
+    /// @brief Accepts onto the same socket over and over; the handler has to move it out before returning.
+    /// One accept is in flight at a time, see accept_engine.hpp for a listener that keeps several.
     template<class Acceptor, class Socket, class Handler>
     void async_accept_loop(Acceptor& acceptor, Socket& socket, Handler&& handler)
     {
+        auto allocator = boost::asio::get_associated_allocator(handler);
+        
         acceptor.async_accept(socket,
-                              [&acceptor, &socket, handler](const boost::system::error_code& ec)
+                              bind_associated_allocator(allocator,
+                              [&acceptor, &socket, handler = std::forward<Handler>(handler)](const boost::system::error_code& ec) mutable
                               {
                                   handler(ec);
                                   
                                   if(!ec.failed())
-                                      async_accept_loop(acceptor, socket, handler);
-                              });
+                                      async_accept_loop(acceptor, socket, std::move(handler));
+                              }));
     }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    // Coroutine counterparts of the callback API above. Failures are thrown as boost::system::system_error.
+    // Coroutine frames come from asio's per-thread recycling allocator, so a frame costs one allocation: its buffer.
+
+    /// @brief Reads one size-prefixed frame into the buffer make_buffer(size) returns for its size.
+    template<class SPTraits = sp_default, class Socket, class MakeBuffer>
+    boost::asio::awaitable<shared_buffer> read_frame_into(Socket& socket, MakeBuffer make_buffer)
+    {
+        using size_type = typename SPTraits::size_type;
+
+        size_type size;
+        co_await boost::asio::async_read(socket, boost::asio::mutable_buffer(&size, sizeof(size)), boost::asio::use_awaitable);
+        SPTraits::in(size);
+
+        // The size came from the peer, so an allocation failure only fails this read
+        shared_buffer buffer;
+        try
+        {
+            buffer = make_buffer(size);
+        }
+        catch (const std::bad_alloc&)
+        {
+            throw boost::system::system_error(boost::asio::error::no_memory);
+        }
+
+        co_await boost::asio::async_read(socket, boost::asio::mutable_buffer(buffer.data(), buffer.size()), boost::asio::use_awaitable);
+
+        co_return buffer;
+    }
+
+    /// @brief Reads one size-prefixed frame.
+    template<class SPTraits = sp_default, class Socket>
+    boost::asio::awaitable<shared_buffer> read_frame(Socket& socket)
+    {
+        return read_frame_into<SPTraits>(socket, [](std::size_t size) { return shared_buffer{ size }; });
+    }
+
+    /// @brief Reads one size-prefixed frame into a buffer from the pool, see the pooled async_read_sp. The pool has to outlive the read.
+    template<class SPTraits = sp_default, class Socket>
+    boost::asio::awaitable<shared_buffer> read_frame(Socket& socket, buffer_pool& pool)
+    {
+        return read_frame_into<SPTraits>(socket, [&pool](std::size_t size) { return pool.acquire(size); });
+    }
+
+    /// @brief Writes the bytes with their size prefix in one gathered write. The bytes have to stay alive until it completes.
+    template<class SPTraits = sp_default, class Socket>
+    boost::asio::awaitable<void> write_frame(Socket& socket, boost::asio::const_buffer bytes)
+    {
+        using size_type = typename SPTraits::size_type;
+
+        auto size = (size_type)bytes.size();
+        SPTraits::out(size);
+
+        std::array<boost::asio::const_buffer, 2> buffers{ boost::asio::const_buffer(&size, sizeof(size)), bytes };
+        co_await boost::asio::async_write(socket, buffers, boost::asio::use_awaitable);
+    }
+
+    template<class SPTraits = sp_default, class Socket>
+    boost::asio::awaitable<void> write_frame(Socket& socket, shared_buffer buffer)
+    {
+        co_await write_frame<SPTraits>(socket, boost::asio::const_buffer(buffer.data(), buffer.size()));
+    }
+
+    /// @brief Accepts one connection. Loop over it to serve an acceptor.
+    template<class Acceptor>
+    auto accept(Acceptor& acceptor)
+    {
+        return acceptor.async_accept(boost::asio::use_awaitable);
+    }
+
+    /// @brief Accepts one connection onto a socket bound to another executor, e.g. a different io_context.
+    template<class Acceptor, class Executor>
+    auto accept(Acceptor& acceptor, const Executor& executor)
+    {
+        return acceptor.async_accept(executor, boost::asio::use_awaitable);
+    }
+#endif
 }
 
 #undef BACS_CONFIG_HOSTPORT
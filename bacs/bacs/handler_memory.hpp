@@ -0,0 +1,253 @@
+//
+//  handler_memory.hpp
+//  bacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <boost/asio.hpp>
+
+namespace bacs
+{
+    /// @brief A fixed set of equally sized blocks that asio handlers (and the small state they share) are allocated from.
+    /// Freed blocks are reused right away, so a connection that keeps the same operations in flight stops touching the
+    /// global heap once it is running. Requests that don't fit, or that arrive while every block is taken, fall back to it.
+    /// Thread-safe. Created through create(); the memory lives on until its owner drops it and every allocation has come back,
+    /// so it can sit in the same state block its handlers keep alive.
+    class handler_memory
+    {
+    public:
+        static constexpr std::size_t default_block_size = 512;
+
+        struct deleter
+        {
+            void operator()(handler_memory* memory) const noexcept
+            {
+                memory->release();
+            }
+        };
+
+        using pointer = std::unique_ptr<handler_memory, deleter>;
+
+        static pointer create(std::size_t blocks = 4, std::size_t block_size = default_block_size)
+        {
+            return pointer(new handler_memory(blocks, block_size));
+        }
+
+        handler_memory(const handler_memory&) = delete;
+        handler_memory& operator=(const handler_memory&) = delete;
+
+        void* allocate(std::size_t size)
+        {
+            // Every allocation holds a reference, which is what lets the owner go away before the last handler does
+            _references.fetch_add(1, std::memory_order_relaxed);
+
+            if (size <= _block_size)
+            {
+                auto start = _next.load(std::memory_order_relaxed);
+
+                for (std::size_t i = 0; i < _blocks; i++)
+                {
+                    auto index = (start + i) % _blocks;
+
+                    if (!_in_use[index].load(std::memory_order_relaxed) && !_in_use[index].exchange(true, std::memory_order_acquire))
+                    {
+                        _next.store(index + 1, std::memory_order_relaxed);
+                        return block(index);
+                    }
+                }
+            }
+
+            return ::operator new(size);
+        }
+
+        void deallocate(void* pointer, std::size_t size)
+        {
+            auto offset = (std::uintptr_t)pointer - (std::uintptr_t)_storage.get();
+
+            // Pointers below the storage wrap around to huge offsets and fail the check too
+            if (offset < _block_size * _blocks)
+            {
+                auto index = offset / _block_size;
+                _in_use[index].store(false, std::memory_order_release);
+                _next.store(index, std::memory_order_relaxed);
+            }
+            else
+            {
+                ::operator delete(pointer, size);
+            }
+
+            release();
+        }
+
+        std::size_t block_size() const
+        {
+            return _block_size;
+        }
+
+        std::size_t blocks() const
+        {
+            return _blocks;
+        }
+
+    private:
+        handler_memory(std::size_t blocks, std::size_t block_size)
+        : _block_size(round_up(block_size)), _blocks(blocks ? blocks : 1),
+          _storage(new std::max_align_t[_block_size * _blocks / sizeof(std::max_align_t)]),
+          _in_use(new std::atomic<bool>[_blocks])
+        {
+            for (std::size_t i = 0; i < _blocks; i++)
+                _in_use[i].store(false, std::memory_order_relaxed);
+        }
+
+        void release() noexcept
+        {
+            if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+
+        static std::size_t round_up(std::size_t size)
+        {
+            auto align = sizeof(std::max_align_t);
+            return (size + align - 1) / align * align;
+        }
+
+        void* block(std::size_t index)
+        {
+            return (char*)_storage.get() + index * _block_size;
+        }
+
+        std::size_t _block_size;
+        std::size_t _blocks;
+        std::unique_ptr<std::max_align_t[]> _storage;
+        std::unique_ptr<std::atomic<bool>[]> _in_use;
+        std::atomic<std::size_t> _next = 0;
+        std::atomic<std::size_t> _references = 1;
+    };
+
+    /// @brief A standard allocator over a handler_memory, to be associated with handlers through bind_allocator().
+    /// Copies compare equal as long as they share the memory. Allocate only while the memory's owner still holds it.
+    template<class T = void>
+    class handler_allocator
+    {
+    public:
+        using value_type = T;
+
+        explicit handler_allocator(handler_memory& memory) noexcept
+        : _memory(&memory)
+        {}
+
+        template<class U>
+        handler_allocator(const handler_allocator<U>& other) noexcept
+        : _memory(other._memory)
+        {}
+
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(_memory->allocate(sizeof(T) * n));
+        }
+
+        void deallocate(T* pointer, std::size_t n)
+        {
+            _memory->deallocate(pointer, sizeof(T) * n);
+        }
+
+        template<class U>
+        bool operator==(const handler_allocator<U>& other) const noexcept
+        {
+            return _memory == other._memory;
+        }
+
+        template<class U>
+        bool operator!=(const handler_allocator<U>& other) const noexcept
+        {
+            return _memory != other._memory;
+        }
+
+    private:
+        template<class>
+        friend class handler_allocator;
+
+        handler_memory* _memory;
+    };
+
+    /// @brief Wraps a handler so that asio's get_associated_allocator() returns the given allocator for it.
+    /// The wrapped handler's associated executor is kept.
+    template<class Allocator, class Handler>
+    class allocator_binder
+    {
+    public:
+        using allocator_type = Allocator;
+
+        template<class H>
+        allocator_binder(const Allocator& allocator, H&& handler)
+        : _allocator(allocator), _handler(std::forward<H>(handler))
+        {}
+
+        allocator_type get_allocator() const noexcept
+        {
+            return _allocator;
+        }
+
+        Handler& get() noexcept
+        {
+            return _handler;
+        }
+
+        const Handler& get() const noexcept
+        {
+            return _handler;
+        }
+
+        template<class... Args>
+        decltype(auto) operator()(Args&&... args)
+        {
+            return _handler(std::forward<Args>(args)...);
+        }
+
+    private:
+        Allocator _allocator;
+        Handler _handler;
+    };
+
+    /// @brief Associates an allocator with a completion handler, like asio's own bind_allocator from later Boost versions.
+    template<class Allocator, class Handler>
+    auto bind_allocator(const Allocator& allocator, Handler&& handler)
+    {
+        return allocator_binder<Allocator, std::decay_t<Handler>>(allocator, std::forward<Handler>(handler));
+    }
+
+    /// @brief Gives an intermediate handler the allocator associated with the user's handler, so every step of a composed
+    /// operation allocates from the same place. Take the allocator before moving the user's handler into the intermediate one.
+    /// With the default allocator the handler is passed through untouched.
+    template<class Allocator, class Handler>
+    auto bind_associated_allocator(const Allocator& allocator, Handler&& handler)
+    {
+        if constexpr (std::is_same_v<Allocator, std::allocator<void>>)
+            return std::decay_t<Handler>(std::forward<Handler>(handler));
+        else
+            return bind_allocator(allocator, std::forward<Handler>(handler));
+    }
+}
+
+namespace boost::asio
+{
+    template<class Allocator, class Handler, class Executor>
+    struct associated_executor<bacs::allocator_binder<Allocator, Handler>, Executor>
+    {
+        using type = associated_executor_t<Handler, Executor>;
+
+        static type get(const bacs::allocator_binder<Allocator, Handler>& binder, const Executor& executor = Executor()) noexcept
+        {
+            return associated_executor<Handler, Executor>::get(binder.get(), executor);
+        }
+    };
+}
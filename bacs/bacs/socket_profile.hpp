@@ -0,0 +1,139 @@
+//
+//  socket_profile.hpp
+//  bacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bacs.hpp"
+
+#include <optional>
+#include <type_traits>
+
+namespace bacs
+{
+#if defined(TCP_CORK)
+    using tcp_cork = boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_CORK>;
+#endif
+#if defined(TCP_QUICKACK)
+    using tcp_quick_ack = boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK>;
+#endif
+#if defined(TCP_KEEPIDLE)
+    using tcp_keep_alive_idle = boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPIDLE>;
+    using tcp_keep_alive_interval = boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPINTVL>;
+    using tcp_keep_alive_count = boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPCNT>;
+#endif
+#if defined(SO_BUSY_POLL)
+    using busy_poll = boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>;
+#endif
+
+    /// @brief Socket options to set on a stream socket right after it's accepted or connected. Unset options are left alone;
+    /// TCP-only ones are skipped for other protocols and for platforms that lack them.
+    struct socket_profile
+    {
+        std::optional<bool> no_delay;
+        std::optional<int> send_buffer_size;
+        std::optional<int> receive_buffer_size;
+
+        /// @brief Linux turns quick ACKs back off by itself once it goes into delayed ACK mode, so this mostly speeds up the start.
+        std::optional<bool> quick_ack;
+
+        std::optional<bool> keep_alive;
+        std::optional<int> keep_alive_idle_s;
+        std::optional<int> keep_alive_interval_s;
+        std::optional<int> keep_alive_count;
+
+        /// @brief Microseconds to busy-poll the device queue on blocking reads. Going above net.core.busy_read needs CAP_NET_ADMIN.
+        std::optional<int> busy_poll_us;
+
+        /// @brief Cork the socket for as long as a StreamClient has writes queued and uncork it once they drain,
+        /// so back-to-back batches leave in full segments and the tail still goes out immediately.
+        bool cork_while_queued = false;
+
+        /// @brief Small packets that have to go out right away, and a quick check on dead peers.
+        static socket_profile low_latency()
+        {
+            socket_profile profile;
+            profile.no_delay = true;
+            profile.quick_ack = true;
+            profile.keep_alive = true;
+            profile.keep_alive_idle_s = 10;
+            profile.keep_alive_interval_s = 5;
+            profile.keep_alive_count = 3;
+            profile.busy_poll_us = 50;
+            return profile;
+        }
+
+        /// @brief Bulk transfers: big kernel buffers and full segments.
+        static socket_profile high_throughput()
+        {
+            socket_profile profile;
+            profile.no_delay = true;
+            profile.send_buffer_size = 4 << 20;
+            profile.receive_buffer_size = 4 << 20;
+            profile.keep_alive = true;
+            profile.cork_while_queued = true;
+            return profile;
+        }
+    };
+
+    namespace detail
+    {
+        template<class Socket>
+        constexpr bool is_tcp_socket = std::is_same_v<typename Socket::protocol_type, boost::asio::ip::tcp>;
+
+        template<class Socket, class Option, class Value>
+        void set_profile_option(Socket& socket, const std::optional<Value>& value, boost::system::error_code& first_error)
+        {
+            if (!value)
+                return;
+
+            boost::system::error_code ec;
+            socket.set_option(Option(*value), ec);
+
+            if (ec && !first_error)
+                first_error = ec;
+        }
+    }
+
+    /// @brief Applies every option in the profile, even after one fails.
+    /// @return The first error, e.g. from an option the process isn't allowed to set
+    template<class Socket>
+    boost::system::error_code apply_socket_profile(Socket& socket, const socket_profile& profile)
+    {
+        boost::system::error_code first_error;
+
+        detail::set_profile_option<Socket, boost::asio::socket_base::send_buffer_size>(socket, profile.send_buffer_size, first_error);
+        detail::set_profile_option<Socket, boost::asio::socket_base::receive_buffer_size>(socket, profile.receive_buffer_size, first_error);
+        detail::set_profile_option<Socket, boost::asio::socket_base::keep_alive>(socket, profile.keep_alive, first_error);
+#if defined(SO_BUSY_POLL)
+        detail::set_profile_option<Socket, busy_poll>(socket, profile.busy_poll_us, first_error);
+#endif
+
+        if constexpr (detail::is_tcp_socket<Socket>)
+        {
+            detail::set_profile_option<Socket, boost::asio::ip::tcp::no_delay>(socket, profile.no_delay, first_error);
+#if defined(TCP_QUICKACK)
+            detail::set_profile_option<Socket, tcp_quick_ack>(socket, profile.quick_ack, first_error);
+#endif
+#if defined(TCP_KEEPIDLE)
+            detail::set_profile_option<Socket, tcp_keep_alive_idle>(socket, profile.keep_alive_idle_s, first_error);
+            detail::set_profile_option<Socket, tcp_keep_alive_interval>(socket, profile.keep_alive_interval_s, first_error);
+            detail::set_profile_option<Socket, tcp_keep_alive_count>(socket, profile.keep_alive_count, first_error);
+#endif
+        }
+
+        return first_error;
+    }
+
+    /// @brief Corks or uncorks a TCP socket. Does nothing for other sockets and where TCP_CORK doesn't exist.
+    template<class Socket>
+    void set_cork(Socket& socket, bool cork, boost::system::error_code& ec)
+    {
+#if defined(TCP_CORK)
+        if constexpr (detail::is_tcp_socket<Socket>)
+            socket.set_option(tcp_cork(cork), ec);
+#endif
+    }
+}
@@ -0,0 +1,180 @@
+//
+//  unique_function.hpp
+//  bacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bacs
+{
+    template<class Signature, std::size_t InlineSize = 4 * sizeof(void*)>
+    class unique_function;
+
+    /// @brief A move-only std::function. Targets that fit into InlineSize bytes and are nothrow movable are stored
+    /// inline, so moving one through a chain of async operations never allocates; larger ones live on the heap.
+    template<class R, class... Args, std::size_t InlineSize>
+    class unique_function<R(Args...), InlineSize>
+    {
+    public:
+        unique_function() noexcept = default;
+
+        unique_function(std::nullptr_t) noexcept
+        {}
+
+        template<class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, unique_function> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+        unique_function(F&& f)
+        {
+            using Target = std::decay_t<F>;
+
+            // Empty std::functions and null pointers make an empty unique_function, like they would a std::function
+            if constexpr (std::is_pointer_v<Target> || std::is_member_pointer_v<Target> || is_std_function<Target>::value)
+            {
+                if (!f)
+                    return;
+            }
+
+            if constexpr (stored_inline<Target>)
+                new (&_storage) Target(std::forward<F>(f));
+            else
+                *reinterpret_cast<Target**>(&_storage) = new Target(std::forward<F>(f));
+
+            _vtable = &vtable_for<Target>;
+        }
+
+        unique_function(const unique_function&) = delete;
+        unique_function& operator=(const unique_function&) = delete;
+
+        unique_function(unique_function&& other) noexcept
+        {
+            take(other);
+        }
+
+        unique_function& operator=(unique_function&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                take(other);
+            }
+
+            return *this;
+        }
+
+        unique_function& operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        ~unique_function()
+        {
+            reset();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return _vtable != nullptr;
+        }
+
+        R operator()(Args... args) const
+        {
+            if (!_vtable)
+                throw std::bad_function_call();
+
+            return _vtable->invoke(const_cast<void*>(static_cast<const void*>(&_storage)), std::forward<Args>(args)...);
+        }
+
+    private:
+        template<class T>
+        struct is_std_function : std::false_type
+        {};
+
+        template<class Signature>
+        struct is_std_function<std::function<Signature>> : std::true_type
+        {};
+
+        struct vtable
+        {
+            R (*invoke)(void* storage, Args&&... args);
+            void (*move)(void* from, void* to) noexcept;
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template<class Target>
+        static constexpr bool stored_inline = sizeof(Target) <= InlineSize &&
+                                              alignof(Target) <= alignof(std::max_align_t) &&
+                                              std::is_nothrow_move_constructible_v<Target>;
+
+        template<class Target>
+        static Target& target(void* storage)
+        {
+            if constexpr (stored_inline<Target>)
+                return *std::launder(reinterpret_cast<Target*>(storage));
+            else
+                return **reinterpret_cast<Target**>(storage);
+        }
+
+        template<class Target>
+        static R invoke(void* storage, Args&&... args)
+        {
+            return std::invoke(target<Target>(storage), std::forward<Args>(args)...);
+        }
+
+        template<class Target>
+        static void move(void* from, void* to) noexcept
+        {
+            if constexpr (stored_inline<Target>)
+            {
+                new (to) Target(std::move(target<Target>(from)));
+                target<Target>(from).~Target();
+            }
+            else
+            {
+                *reinterpret_cast<Target**>(to) = *reinterpret_cast<Target**>(from);
+            }
+        }
+
+        template<class Target>
+        static void destroy(void* storage) noexcept
+        {
+            if constexpr (stored_inline<Target>)
+                target<Target>(storage).~Target();
+            else
+                delete *reinterpret_cast<Target**>(storage);
+        }
+
+        template<class Target>
+        static constexpr vtable vtable_for{ &invoke<Target>, &move<Target>, &destroy<Target> };
+
+        void take(unique_function& other) noexcept
+        {
+            if (other._vtable)
+            {
+                other._vtable->move(&other._storage, &_storage);
+                _vtable = other._vtable;
+                other._vtable = nullptr;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (_vtable)
+            {
+                _vtable->destroy(&_storage);
+                _vtable = nullptr;
+            }
+        }
+
+        static constexpr std::size_t StorageSize = InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize;
+
+        alignas(std::max_align_t) unsigned char _storage[StorageSize];
+        const vtable* _vtable = nullptr;
+    };
+}
@@ -0,0 +1,158 @@
+//
+//  bacs_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+
+#include <bacs/bacs.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace
+{
+    using Socket = boost::asio::local::stream_protocol::socket;
+
+    // One size-prefixed frame written on one end of a socket pair and read back on the other
+    void RoundTripCase(bench::state& state, std::size_t size)
+    {
+        boost::asio::io_context context;
+        Socket writer{ context };
+        Socket reader{ context };
+        boost::asio::local::connect_pair(writer, reader);
+
+        std::vector<uint8_t> payload(size, 0x42);
+        state.set_bytes_per_op((double)size);
+
+        state.run([&]
+        {
+            std::size_t received = 0;
+
+            bacs::async_write_sp(writer, payload, [](const boost::system::error_code&, std::size_t) {});
+            bacs::async_read_sp(reader,
+                [&received](const boost::system::error_code&, std::size_t, bacs::shared_buffer buffer)
+                {
+                    received = buffer.size();
+                });
+
+            context.restart();
+            context.run();
+
+            if (received != payload.size())
+                throw std::runtime_error("bacs round trip: short frame");
+        });
+    }
+
+    BENCH_CASE("bacs/round_trip_sp/64", [](bench::state& state) { RoundTripCase(state, 64); });
+    BENCH_CASE("bacs/round_trip_sp/1024", [](bench::state& state) { RoundTripCase(state, 1024); });
+    BENCH_CASE("bacs/round_trip_sp/16384", [](bench::state& state) { RoundTripCase(state, 16384); });
+
+    // A shared_buffer round trip, with or without handler memory bound to both sides, optionally receiving into pooled
+    // buffers. Reports global allocations per round trip: with handler memory only the received frame's buffer should be
+    // left, and with the pool on top only an executor_function that Boost 1.74's any_io_executor always takes from the
+    // default allocator, which nothing can be bound to avoid.
+    void RoundTripBufferCase(bench::state& state, std::size_t size, bool handlerMemory, bool pooled = false)
+    {
+        boost::asio::io_context context;
+        Socket writer{ context };
+        Socket reader{ context };
+        boost::asio::local::connect_pair(writer, reader);
+
+        bacs::shared_buffer payload{ size };
+        std::fill(payload.begin(), payload.end(), 0x42);
+        state.set_bytes_per_op((double)size);
+
+        auto memory = bacs::handler_memory::create();
+        bacs::buffer_pool pool{ size };
+        std::size_t received = 0;
+
+        auto onWrite = [](const boost::system::error_code&, std::size_t) {};
+        auto onRead = [&received](const boost::system::error_code&, std::size_t, bacs::shared_buffer buffer)
+        {
+            received = buffer.size();
+        };
+
+        auto roundTrip = [&]
+        {
+            received = 0;
+
+            if (pooled)
+            {
+                bacs::async_write_sp(writer, payload, bacs::bind_allocator(bacs::handler_allocator<>(*memory), onWrite));
+                bacs::async_read_sp(reader, pool, bacs::bind_allocator(bacs::handler_allocator<>(*memory), onRead));
+            }
+            else if (handlerMemory)
+            {
+                bacs::async_write_sp(writer, payload, bacs::bind_allocator(bacs::handler_allocator<>(*memory), onWrite));
+                bacs::async_read_sp(reader, bacs::bind_allocator(bacs::handler_allocator<>(*memory), onRead));
+            }
+            else
+            {
+                bacs::async_write_sp(writer, payload, onWrite);
+                bacs::async_read_sp(reader, onRead);
+            }
+
+            context.restart();
+            context.run();
+
+            if (received != payload.size())
+                throw std::runtime_error("bacs round trip: short frame");
+        };
+
+        state.run(roundTrip);
+
+        auto allocations = bench::allocations_per_op(roundTrip);
+        state.set_counter("allocs_per_op", allocations);
+
+        if (pooled && allocations > 1)
+            throw std::runtime_error("bacs round trip: a pooled round trip allocated more than its executor_function");
+    }
+
+    BENCH_CASE("bacs/round_trip_buffer/64", [](bench::state& state) { RoundTripBufferCase(state, 64, false); });
+    BENCH_CASE("bacs/round_trip_buffer_handler_memory/64", [](bench::state& state) { RoundTripBufferCase(state, 64, true); });
+    BENCH_CASE("bacs/round_trip_buffer_pooled/64", [](bench::state& state) { RoundTripBufferCase(state, 64, true, true); });
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    // The same round trip through write_frame/read_frame
+    void RoundTripFrameCase(bench::state& state, std::size_t size)
+    {
+        boost::asio::io_context context;
+        Socket writer{ context };
+        Socket reader{ context };
+        boost::asio::local::connect_pair(writer, reader);
+
+        bacs::shared_buffer payload{ size };
+        std::fill(payload.begin(), payload.end(), 0x42);
+        state.set_bytes_per_op((double)size);
+
+        state.run([&]
+        {
+            std::size_t received = 0;
+
+            boost::asio::co_spawn(context, bacs::write_frame(writer, payload), boost::asio::detached);
+            boost::asio::co_spawn(context,
+                [&]() -> boost::asio::awaitable<void>
+                {
+                    received = (co_await bacs::read_frame(reader)).size();
+                }, boost::asio::detached);
+
+            context.restart();
+            context.run();
+
+            if (received != payload.size())
+                throw std::runtime_error("bacs round trip: short frame");
+        });
+    }
+
+    BENCH_CASE("bacs/round_trip_frame/64", [](bench::state& state) { RoundTripFrameCase(state, 64); });
+    BENCH_CASE("bacs/round_trip_frame/1024", [](bench::state& state) { RoundTripFrameCase(state, 1024); });
+    BENCH_CASE("bacs/round_trip_frame/16384", [](bench::state& state) { RoundTripFrameCase(state, 16384); });
+#endif
+}
+
+#endif
@@ -0,0 +1,159 @@
+//
+//  bench.hpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    /// @brief Keeps the compiler from optimizing away a value or the computation producing it.
+    template<class T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    struct settings
+    {
+        double min_time = 0.1;
+        std::size_t repetitions = 5;
+        std::string filter;
+    };
+
+    struct result
+    {
+        std::string name;
+        std::size_t iterations = 0;
+        double ns_per_op = 0;
+        double ns_per_op_min = 0;
+        double ns_per_op_max = 0;
+        double bytes_per_op = 0;
+        double items_per_op = 0;
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    /// @brief Passed to every benchmark case. The case does its setup, then hands the measured operation to run().
+    class state
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        state(const settings& settings, result& result)
+            : _settings(settings), _result(result)
+        {}
+
+        /// @brief Calibrates an iteration count that runs for at least min_time, then times several repetitions of it.
+        template<class F>
+        void run(F&& op)
+        {
+            std::size_t iterations = 1;
+
+            for (;;)
+            {
+                auto elapsed = time(op, iterations);
+
+                if (elapsed >= _settings.min_time || iterations >= (std::size_t(1) << 40))
+                    break;
+
+                auto scale = elapsed > 0 ? std::min(10.0, 1.4 * _settings.min_time / elapsed) : 10.0;
+                iterations = std::max(iterations + 1, (std::size_t)(iterations * scale));
+            }
+
+            std::vector<double> samples;
+            for (std::size_t r = 0; r < std::max<std::size_t>(1, _settings.repetitions); r++)
+                samples.push_back(time(op, iterations) * 1e9 / iterations);
+
+            std::sort(samples.begin(), samples.end());
+
+            _result.iterations = iterations;
+            _result.ns_per_op = samples[samples.size() / 2];
+            _result.ns_per_op_min = samples.front();
+            _result.ns_per_op_max = samples.back();
+        }
+
+        /// @brief Bytes processed by a single operation, reported as throughput.
+        void set_bytes_per_op(double bytes)
+        {
+            _result.bytes_per_op = bytes;
+        }
+
+        /// @brief Items processed by a single operation, reported as throughput.
+        void set_items_per_op(double items)
+        {
+            _result.items_per_op = items;
+        }
+
+        /// @brief Reports an extra named value for this case, e.g. allocations per operation.
+        void set_counter(std::string name, double value)
+        {
+            _result.counters.emplace_back(std::move(name), value);
+        }
+
+    private:
+        template<class F>
+        static double time(F& op, std::size_t iterations)
+        {
+            auto start = clock::now();
+
+            for (std::size_t i = 0; i < iterations; i++)
+                op();
+
+            return std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        const settings& _settings;
+        result& _result;
+    };
+
+    /// @brief The number of global operator new calls made so far by the whole process. Counted in main.cpp.
+    std::size_t allocation_count();
+
+    /// @brief Runs an operation a fixed number of times and returns how many global allocations it made per run.
+    template<class F>
+    double allocations_per_op(F&& op, std::size_t iterations = 1000)
+    {
+        auto before = allocation_count();
+
+        for (std::size_t i = 0; i < iterations; i++)
+            op();
+
+        return (double)(allocation_count() - before) / iterations;
+    }
+
+    using case_function = std::function<void(state&)>;
+
+    inline std::vector<std::pair<std::string, case_function>>& registry()
+    {
+        static std::vector<std::pair<std::string, case_function>> cases;
+        return cases;
+    }
+
+    struct registrator
+    {
+        registrator(std::string name, case_function function)
+        {
+            registry().emplace_back(std::move(name), std::move(function));
+        }
+    };
+}
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+
+/// @brief Registers a benchmark case: BENCH_CASE("module/what", [](bench::state& state) { ...; state.run([&] { ... }); });
+#define BENCH_CASE(name, ...) static ::bench::registrator BENCH_CONCAT(bench_registrator_, __LINE__){ name, __VA_ARGS__ }
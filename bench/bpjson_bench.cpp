@@ -0,0 +1,285 @@
+//
+//  bpjson_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+#include "types.hpp"
+
+#include <bpjson/bpjson.hpp>
+#include <bpjson/nlohmann_traits.hpp>
+#include <bpjson/batch_reader.hpp>
+#include <bpjson/sax_reader.hpp>
+#include <bpjson/text_writer.hpp>
+
+#if __has_include(<simdjson.h>)
+#include <bpjson/simdjson_traits.hpp>
+#define BENCH_HAS_SIMDJSON
+#endif
+
+namespace
+{
+    using Json = nlohmann::json;
+    using Serializer = bpjson::json_serializer<Json>;
+    using namespace bench_types;
+
+    std::string MakeRecordArrayText(uint32_t n)
+    {
+        std::vector<JsonRecord> records;
+        for (uint32_t i = 0; i < n; i++)
+            records.push_back(MakeJsonRecord(i));
+
+        return Serializer::write(records).dump();
+    }
+
+    BENCH_CASE("bpjson/write/record", [](bench::state& state)
+    {
+        auto record = MakeJsonRecord();
+        state.set_bytes_per_op((double)Serializer::write(record).dump().size());
+
+        state.run([&]
+        {
+            auto json = Serializer::write(record);
+            bench::do_not_optimize(json);
+        });
+    });
+
+    BENCH_CASE("bpjson/read/record", [](bench::state& state)
+    {
+        auto json = Serializer::write(MakeJsonRecord());
+        state.set_bytes_per_op((double)json.dump().size());
+
+        state.run([&]
+        {
+            auto record = Serializer::read<JsonRecord>(json);
+            bench::do_not_optimize(record);
+        });
+    });
+
+    BENCH_CASE("bpjson/write_dump/record", [](bench::state& state)
+    {
+        auto record = MakeJsonRecord();
+        state.set_bytes_per_op((double)Serializer::write(record).dump().size());
+
+        state.run([&]
+        {
+            auto text = Serializer::write(record).dump();
+            bench::do_not_optimize(text.data());
+        });
+    });
+
+    BENCH_CASE("bpjson/parse_read/record", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeJsonRecord()).dump();
+        state.set_bytes_per_op((double)text.size());
+
+        state.run([&]
+        {
+            auto record = Serializer::read<JsonRecord>(Json::parse(text));
+            bench::do_not_optimize(record);
+        });
+    });
+
+    BENCH_CASE("bpjson/read/nested_containers", [](bench::state& state)
+    {
+        auto json = Serializer::write(MakeNestedContainers());
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { Serializer::read<NestedContainers>(json); }));
+
+        state.run([&]
+        {
+            auto value = Serializer::read<NestedContainers>(json);
+            bench::do_not_optimize(value);
+        });
+    });
+
+    BENCH_CASE("bpjson/write/nested_containers", [](bench::state& state)
+    {
+        auto value = MakeNestedContainers();
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { Serializer::write(value); }));
+
+        state.run([&]
+        {
+            auto json = Serializer::write(value);
+            bench::do_not_optimize(json);
+        });
+    });
+
+    BENCH_CASE("bpjson/read/wide_record", [](bench::state& state)
+    {
+        auto json = Serializer::write(MakeWideRecord());
+
+        state.run([&]
+        {
+            auto record = Serializer::read<WideRecord>(json);
+            bench::do_not_optimize(record);
+        });
+    });
+
+    BENCH_CASE("bpjson/sax_read/record", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeJsonRecord()).dump();
+        bpjson::sax_reader<Json> reader;
+        state.set_bytes_per_op((double)text.size());
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { reader.read<JsonRecord>(text); }));
+
+        state.run([&]
+        {
+            auto record = reader.read<JsonRecord>(text);
+            bench::do_not_optimize(record);
+        });
+    });
+
+    // A large document, where the DOM path has to hold the whole tree next to the result
+    BENCH_CASE("bpjson/parse_read/records_4096", [](bench::state& state)
+    {
+        auto text = MakeRecordArrayText(4096);
+        state.set_bytes_per_op((double)text.size());
+        state.set_items_per_op(4096);
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { Serializer::read<std::vector<JsonRecord>>(Json::parse(text)); }, 4));
+
+        state.run([&]
+        {
+            auto records = Serializer::read<std::vector<JsonRecord>>(Json::parse(text));
+            bench::do_not_optimize(records);
+        });
+    });
+
+    BENCH_CASE("bpjson/sax_read/records_4096", [](bench::state& state)
+    {
+        auto text = MakeRecordArrayText(4096);
+        bpjson::sax_reader<Json> reader;
+        state.set_bytes_per_op((double)text.size());
+        state.set_items_per_op(4096);
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { reader.read<std::vector<JsonRecord>>(text); }, 4));
+
+        state.run([&]
+        {
+            auto records = reader.read<std::vector<JsonRecord>>(text);
+            bench::do_not_optimize(records);
+        });
+    });
+
+    BENCH_CASE("bpjson/text_write/record", [](bench::state& state)
+    {
+        auto record = MakeJsonRecord();
+        std::string text;
+        state.set_bytes_per_op((double)bpjson::text_writer<Json>::write(record).size());
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { text.clear(); bpjson::text_writer<Json>::write_to(text, record); }));
+
+        state.run([&]
+        {
+            text.clear();
+            bpjson::text_writer<Json>::write_to(text, record);
+            bench::do_not_optimize(text.data());
+        });
+    });
+
+    BENCH_CASE("bpjson/write_dump/records_4096", [](bench::state& state)
+    {
+        std::vector<JsonRecord> records;
+        for (uint32_t i = 0; i < 4096; i++)
+            records.push_back(MakeJsonRecord(i));
+
+        state.set_items_per_op(4096);
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { Serializer::write(records).dump(); }, 4));
+
+        state.run([&]
+        {
+            auto text = Serializer::write(records).dump();
+            bench::do_not_optimize(text.data());
+        });
+    });
+
+    BENCH_CASE("bpjson/text_write/records_4096", [](bench::state& state)
+    {
+        std::vector<JsonRecord> records;
+        for (uint32_t i = 0; i < 4096; i++)
+            records.push_back(MakeJsonRecord(i));
+
+        std::string text;
+        state.set_items_per_op(4096);
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { text.clear(); bpjson::text_writer<Json>::write_to(text, records); }, 4));
+
+        state.run([&]
+        {
+            text.clear();
+            bpjson::text_writer<Json>::write_to(text, records);
+            bench::do_not_optimize(text.data());
+        });
+    });
+
+    std::string MakeRecordLines(uint32_t n)
+    {
+        std::string text;
+        for (uint32_t i = 0; i < n; i++)
+            text += Serializer::write(MakeJsonRecord(i)).dump() + "\n";
+
+        return text;
+    }
+
+    // One thread against every hardware thread; the gap is how well decoding scales on this machine
+    BENCH_CASE("bpjson/batch_read/ndjson_4096/1_thread", [](bench::state& state)
+    {
+        auto text = MakeRecordLines(4096);
+        bpjson::batch_reader<Json> reader;
+        std::vector<JsonRecord> records;
+        state.set_bytes_per_op((double)text.size());
+        state.set_items_per_op(4096);
+
+        state.run([&]
+        {
+            auto errors = reader.read_to(text, bpjson::batch_format::ndjson, records, 1u);
+            bench::do_not_optimize(errors);
+        });
+    });
+
+    BENCH_CASE("bpjson/batch_read/ndjson_4096/all_threads", [](bench::state& state)
+    {
+        auto text = MakeRecordLines(4096);
+        bpjson::batch_reader<Json> reader;
+        std::vector<JsonRecord> records;
+        state.set_bytes_per_op((double)text.size());
+        state.set_items_per_op(4096);
+        state.set_counter("threads", std::thread::hardware_concurrency());
+
+        state.run([&]
+        {
+            auto errors = reader.read_to(text, bpjson::batch_format::ndjson, records);
+            bench::do_not_optimize(errors);
+        });
+    });
+
+#if defined(BENCH_HAS_SIMDJSON)
+    using SimdSerializer = bpjson::json_serializer<simdjson::dom::element>;
+
+    BENCH_CASE("bpjson/simdjson_parse_read/record", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeJsonRecord()).dump();
+        simdjson::dom::parser parser;
+        state.set_bytes_per_op((double)text.size());
+
+        state.run([&]
+        {
+            auto record = SimdSerializer::read<JsonRecord>(parser.parse(text));
+            bench::do_not_optimize(record);
+        });
+    });
+
+    BENCH_CASE("bpjson/simdjson_parse_read/records_4096", [](bench::state& state)
+    {
+        auto text = MakeRecordArrayText(4096);
+        simdjson::dom::parser parser;
+        state.set_bytes_per_op((double)text.size());
+        state.set_items_per_op(4096);
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&] { SimdSerializer::read<std::vector<JsonRecord>>(parser.parse(text)); }, 4));
+
+        state.run([&]
+        {
+            auto records = SimdSerializer::read<std::vector<JsonRecord>>(parser.parse(text));
+            bench::do_not_optimize(records);
+        });
+    });
+#endif
+}
@@ -0,0 +1,163 @@
+//
+//  bptranscode_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+#include "types.hpp"
+
+#include <bptranscode/bptranscode.hpp>
+#include <bptranscode/sax_transcoder.hpp>
+#include <bpjson/nlohmann_traits.hpp>
+#include <bpjson/text_writer.hpp>
+#include <plakpacs/plakpacs.hpp>
+
+#if __has_include(<simdjson.h>)
+#include <bpjson/simdjson_traits.hpp>
+#define BENCH_HAS_SIMDJSON
+#endif
+
+namespace
+{
+    using Json = nlohmann::json;
+    using Serializer = bpjson::json_serializer<Json>;
+    using Transcoder = bptranscode::transcoder<Json>;
+    using namespace bench_types;
+
+    std::vector<uint8_t> MakeGatewayBytes()
+    {
+        plakpacs::write_stream stream;
+        plakpacs::serializer::write(stream, MakeGatewayMessage());
+        return stream.bytes();
+    }
+
+    // JSON in, plakpacs out: what the gateway does for every client message
+
+    BENCH_CASE("bptranscode/json_to_binary/through_object", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeGatewayMessage()).dump();
+        state.set_bytes_per_op((double)text.size());
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&]
+        {
+            plakpacs::write_stream stream;
+            plakpacs::serializer::write(stream, Serializer::read<GatewayMessage>(Json::parse(text)));
+        }, 16));
+
+        state.run([&]
+        {
+            plakpacs::write_stream stream;
+            plakpacs::serializer::write(stream, Serializer::read<GatewayMessage>(Json::parse(text)));
+            bench::do_not_optimize(stream.bytes().data());
+        });
+    });
+
+    BENCH_CASE("bptranscode/json_to_binary/transcoded", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeGatewayMessage()).dump();
+        state.set_bytes_per_op((double)text.size());
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&]
+        {
+            plakpacs::write_stream stream;
+            Transcoder::json_to_binary<GatewayMessage>(Json::parse(text), stream);
+        }, 16));
+
+        state.run([&]
+        {
+            plakpacs::write_stream stream;
+            Transcoder::json_to_binary<GatewayMessage>(Json::parse(text), stream);
+            bench::do_not_optimize(stream.bytes().data());
+        });
+    });
+
+    BENCH_CASE("bptranscode/json_to_binary/sax_transcoded", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeGatewayMessage()).dump();
+        bptranscode::sax_transcoder<Json> transcoder;
+        state.set_bytes_per_op((double)text.size());
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&]
+        {
+            plakpacs::write_stream stream;
+            transcoder.json_to_binary<GatewayMessage>(text, stream);
+        }, 16));
+
+        state.run([&]
+        {
+            plakpacs::write_stream stream;
+            transcoder.json_to_binary<GatewayMessage>(text, stream);
+            bench::do_not_optimize(stream.bytes().data());
+        });
+    });
+
+#if defined(BENCH_HAS_SIMDJSON)
+    BENCH_CASE("bptranscode/json_to_binary/simdjson_through_object", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeGatewayMessage()).dump();
+        simdjson::dom::parser parser;
+        state.set_bytes_per_op((double)text.size());
+
+        state.run([&]
+        {
+            plakpacs::write_stream stream;
+            plakpacs::serializer::write(stream, bpjson::json_serializer<simdjson::dom::element>::read<GatewayMessage>(parser.parse(text)));
+            bench::do_not_optimize(stream.bytes().data());
+        });
+    });
+
+    BENCH_CASE("bptranscode/json_to_binary/simdjson_transcoded", [](bench::state& state)
+    {
+        auto text = Serializer::write(MakeGatewayMessage()).dump();
+        simdjson::dom::parser parser;
+        state.set_bytes_per_op((double)text.size());
+
+        state.run([&]
+        {
+            plakpacs::write_stream stream;
+            bptranscode::transcoder<simdjson::dom::element>::json_to_binary<GatewayMessage>(parser.parse(text), stream);
+            bench::do_not_optimize(stream.bytes().data());
+        });
+    });
+#endif
+
+    // plakpacs in, JSON out: game server replies on their way back to clients
+
+    BENCH_CASE("bptranscode/binary_to_json/through_object", [](bench::state& state)
+    {
+        auto bytes = MakeGatewayBytes();
+        state.set_bytes_per_op((double)bytes.size());
+
+        state.run([&]
+        {
+            plakpacs::read_stream stream{ bytes };
+            auto text = Serializer::write(plakpacs::serializer::read<GatewayMessage>(stream)).dump();
+            bench::do_not_optimize(text.data());
+        });
+    });
+
+    BENCH_CASE("bptranscode/binary_to_json/through_object_text_writer", [](bench::state& state)
+    {
+        auto bytes = MakeGatewayBytes();
+        state.set_bytes_per_op((double)bytes.size());
+
+        state.run([&]
+        {
+            plakpacs::read_stream stream{ bytes };
+            auto text = bpjson::text_writer<Json>::write(plakpacs::serializer::read<GatewayMessage>(stream));
+            bench::do_not_optimize(text.data());
+        });
+    });
+
+    BENCH_CASE("bptranscode/binary_to_json/transcoded", [](bench::state& state)
+    {
+        auto bytes = MakeGatewayBytes();
+        state.set_bytes_per_op((double)bytes.size());
+
+        state.run([&]
+        {
+            plakpacs::read_stream stream{ bytes };
+            auto text = Transcoder::binary_to_json<GatewayMessage>(stream);
+            bench::do_not_optimize(text.data());
+        });
+    });
+}
@@ -0,0 +1,170 @@
+//
+//  handlers_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+#include "types.hpp"
+
+#include <gspp/packet_handlers.hpp>
+#include <gspp/packet_serializer.hpp>
+
+namespace bench_handlers
+{
+    struct State
+    {
+        std::size_t handled = 0;
+    };
+
+    struct Header
+    {
+        uint16_t id;
+    };
+
+    struct HeaderIdExtractor
+    {
+        static uint16_t Extract(const Header& header)
+        {
+            return header.id;
+        }
+    };
+
+    template<class Schema>
+    struct SchemaIdExtractor;
+
+    template<>
+    struct SchemaIdExtractor<bench_types::FlatPod>
+    {
+        static uint16_t Extract()
+        {
+            return 1;
+        }
+    };
+
+    template<>
+    struct SchemaIdExtractor<bench_types::Nested>
+    {
+        static uint16_t Extract()
+        {
+            return 2;
+        }
+    };
+
+    template<>
+    struct SchemaIdExtractor<bench_types::GatewayMessage>
+    {
+        static uint16_t Extract()
+        {
+            return 3;
+        }
+    };
+
+    template<>
+    struct SchemaIdExtractor<bench_types::PmrGatewayMessage>
+    {
+        static uint16_t Extract()
+        {
+            return 4;
+        }
+    };
+
+    using Handlers = gspp::HandlerSystem<State, Header, uint16_t, HeaderIdExtractor, SchemaIdExtractor>;
+}
+
+BP_DEFINE_REFL_FIELD(bench_handlers::Header, 0, id)
+
+namespace gspp
+{
+    template<>
+    struct PacketSerializer<bench_handlers::Header>
+    {
+        template<class ReadStream>
+        static bench_handlers::Header Deserialize(ReadStream& stream)
+        {
+            return plakpacs::serializer::read<bench_handlers::Header>(stream);
+        }
+    };
+}
+
+template<>
+template<>
+bench_handlers::Handlers::HandlerResult bench_handlers::Handlers::PacketHandlerFunction<bench_types::FlatPod>::Handle(
+    bench_handlers::State& state, const std::pair<bench_handlers::Header, bench_types::FlatPod>& packet)
+{
+    state.handled += packet.second.id;
+    return HandlerResult::Continue;
+}
+
+template<>
+template<>
+bench_handlers::Handlers::HandlerResult bench_handlers::Handlers::PacketHandlerFunction<bench_types::Nested>::Handle(
+    bench_handlers::State& state, const std::pair<bench_handlers::Header, bench_types::Nested>& packet)
+{
+    state.handled += packet.second.pod.id;
+    return HandlerResult::Continue;
+}
+
+template<>
+template<>
+bench_handlers::Handlers::HandlerResult bench_handlers::Handlers::PacketHandlerFunction<bench_types::GatewayMessage>::Handle(
+    bench_handlers::State& state, const std::pair<bench_handlers::Header, bench_types::GatewayMessage>& packet)
+{
+    state.handled += packet.second.items.size() + packet.second.sender.size();
+    return HandlerResult::Continue;
+}
+
+template<>
+template<>
+bench_handlers::Handlers::HandlerResult bench_handlers::Handlers::PacketHandlerFunction<bench_types::PmrGatewayMessage>::Handle(
+    bench_handlers::State& state, const std::pair<bench_handlers::Header, bench_types::PmrGatewayMessage>& packet)
+{
+    state.handled += packet.second.items.size() + packet.second.sender.size();
+    return HandlerResult::Continue;
+}
+
+namespace
+{
+    using namespace bench_handlers;
+
+    Handlers::HandlerRegistrator<bench_types::FlatPod> flatPodRegistrator;
+    Handlers::HandlerRegistrator<bench_types::Nested> nestedRegistrator;
+    Handlers::HandlerRegistrator<bench_types::GatewayMessage> gatewayRegistrator;
+    Handlers::HandlerRegistrator<bench_types::PmrGatewayMessage> pmrGatewayRegistrator;
+
+    template<class Schema>
+    std::vector<uint8_t> MakePacket(uint16_t id, const Schema& schema)
+    {
+        plakpacs::write_stream stream;
+        plakpacs::serializer::write(stream, Header{ id });
+        plakpacs::serializer::write(stream, schema);
+        return stream.bytes();
+    }
+
+    void DispatchCase(bench::state& state, const std::vector<uint8_t>& bytes)
+    {
+        State handlerState;
+        state.set_bytes_per_op((double)bytes.size());
+
+        state.run([&]
+        {
+            auto result = Handlers::HandlerManager::GetInstance().HandlePacket(handlerState, bytes);
+            bench::do_not_optimize(result);
+        });
+
+        state.set_counter("allocs_per_op", bench::allocations_per_op([&]
+        {
+            Handlers::HandlerManager::GetInstance().HandlePacket(handlerState, bytes);
+        }));
+
+        bench::do_not_optimize(handlerState.handled);
+    }
+
+    BENCH_CASE("handlers/dispatch/flat_pod", [](bench::state& state) { DispatchCase(state, MakePacket(1, bench_types::MakeFlatPod())); });
+    BENCH_CASE("handlers/dispatch/nested", [](bench::state& state) { DispatchCase(state, MakePacket(2, bench_types::MakeNested())); });
+    // Same bytes both ways; the second decodes into the per-thread packet arena
+    BENCH_CASE("handlers/dispatch/gateway_heap", [](bench::state& state) { DispatchCase(state, MakePacket(3, bench_types::MakeGatewayMessage())); });
+    BENCH_CASE("handlers/dispatch/gateway_arena", [](bench::state& state) { DispatchCase(state, MakePacket(4, bench_types::MakeGatewayMessage())); });
+    BENCH_CASE("handlers/dispatch/unregistered", [](bench::state& state) { DispatchCase(state, MakePacket(77, bench_types::MakeFlatPod())); });
+}
@@ -0,0 +1,144 @@
+//
+//  main.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+// Runs every registered benchmark case (or those whose name contains --filter) and prints the results,
+// either as a table or, with --json, as one JSON object per line so they can be collected per commit.
+
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <new>
+
+namespace
+{
+    std::atomic<std::size_t> allocations{ 0 };
+}
+
+std::size_t bench::allocation_count()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// Every global allocation is counted so cases can report allocations per operation
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto pointer = std::malloc(size ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    void PrintText(const bench::result& result)
+    {
+        std::printf("%-48s %12zu %14.1f %14.1f", result.name.c_str(), result.iterations, result.ns_per_op,
+                    result.ns_per_op_max - result.ns_per_op_min);
+
+        if (result.bytes_per_op > 0)
+            std::printf(" %12.1f MB/s", result.bytes_per_op / result.ns_per_op * 1e3);
+
+        if (result.items_per_op > 0)
+            std::printf(" %12.0f items/s", result.items_per_op / result.ns_per_op * 1e9);
+
+        for (auto& [name, value] : result.counters)
+            std::printf(" %s=%g", name.c_str(), value);
+
+        std::printf("\n");
+    }
+
+    void PrintJson(const bench::result& result)
+    {
+        std::printf("{\"name\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.3f,\"ns_per_op_min\":%.3f,\"ns_per_op_max\":%.3f",
+                    result.name.c_str(), result.iterations, result.ns_per_op, result.ns_per_op_min, result.ns_per_op_max);
+
+        if (result.bytes_per_op > 0)
+            std::printf(",\"bytes_per_second\":%.1f", result.bytes_per_op / result.ns_per_op * 1e9);
+
+        if (result.items_per_op > 0)
+            std::printf(",\"items_per_second\":%.1f", result.items_per_op / result.ns_per_op * 1e9);
+
+        for (auto& [name, value] : result.counters)
+            std::printf(",\"%s\":%g", name.c_str(), value);
+
+        std::printf("}\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bench::settings settings;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--json"))
+            json = true;
+        else if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+            settings.filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--min-time") && i + 1 < argc)
+            settings.min_time = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--repetitions") && i + 1 < argc)
+            settings.repetitions = (std::size_t)std::atoi(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage: bench [--json] [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N]\n");
+            return 1;
+        }
+    }
+
+    if (!json)
+        std::printf("%-48s %12s %14s %14s\n", "case", "iterations", "ns/op", "spread ns");
+
+    int failures = 0;
+
+    for (auto& [name, function] : bench::registry())
+    {
+        if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos)
+            continue;
+
+        bench::result result;
+        result.name = name;
+
+        try
+        {
+            bench::state state{ settings, result };
+            function(state);
+        }
+        catch (const std::exception& e)
+        {
+            std::fprintf(stderr, "%s: %s\n", name.c_str(), e.what());
+            failures++;
+            continue;
+        }
+
+        if (json)
+            PrintJson(result);
+        else
+            PrintText(result);
+
+        std::fflush(stdout);
+    }
+
+    return failures ? 1 : 0;
+}
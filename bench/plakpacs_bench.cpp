@@ -0,0 +1,95 @@
+//
+//  plakpacs_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+#include "types.hpp"
+
+#include <plakpacs/plakpacs.hpp>
+
+namespace
+{
+    template<class T, class ByteOrder = plakpacs::little_endian>
+    void WriteCase(bench::state& state, const T& value)
+    {
+        plakpacs::basic_write_stream<ByteOrder> probe;
+        plakpacs::serializer::write(probe, value);
+        state.set_bytes_per_op((double)probe.bytes().size());
+
+        state.run([&]
+        {
+            plakpacs::basic_write_stream<ByteOrder> stream;
+            plakpacs::serializer::write(stream, value);
+            bench::do_not_optimize(stream.bytes().data());
+        });
+    }
+
+    template<class T, class ByteOrder = plakpacs::little_endian>
+    void ReadCase(bench::state& state, const T& value)
+    {
+        plakpacs::basic_write_stream<ByteOrder> source;
+        plakpacs::serializer::write(source, value);
+        state.set_bytes_per_op((double)source.bytes().size());
+
+        state.run([&]
+        {
+            plakpacs::basic_read_stream<ByteOrder> stream{ source.bytes() };
+            auto result = plakpacs::serializer::read<T>(stream);
+            bench::do_not_optimize(result);
+        });
+    }
+
+    // A size prefix far past what the constraints allow, followed by as many elements
+    void OversizedCase(bench::state& state)
+    {
+        plakpacs::write_stream source;
+        plakpacs::serializer::write(source, plakpacs::sp_vector<uint16_t>(60000, 1));
+        state.set_bytes_per_op((double)source.bytes().size());
+
+        auto op = [&]
+        {
+            plakpacs::read_stream stream{ source.bytes() };
+            try
+            {
+                auto result = plakpacs::serializer::read<bench_types::Validated>(stream);
+                bench::do_not_optimize(result);
+            }
+            catch (const std::exception&)
+            {
+            }
+        };
+
+        state.run(op);
+        state.set_counter("allocs_per_op", bench::allocations_per_op(op));
+    }
+
+    using namespace bench_types;
+
+    BENCH_CASE("plakpacs/write/flat_pod", [](bench::state& state) { WriteCase(state, MakeFlatPod()); });
+    BENCH_CASE("plakpacs/read/flat_pod", [](bench::state& state) { ReadCase(state, MakeFlatPod()); });
+
+    BENCH_CASE("plakpacs/write/nested", [](bench::state& state) { WriteCase(state, MakeNested()); });
+    BENCH_CASE("plakpacs/read/nested", [](bench::state& state) { ReadCase(state, MakeNested()); });
+
+    BENCH_CASE("plakpacs/write/vectors_64", [](bench::state& state) { WriteCase(state, MakeVectors(64)); });
+    BENCH_CASE("plakpacs/read/vectors_64", [](bench::state& state) { ReadCase(state, MakeVectors(64)); });
+
+    BENCH_CASE("plakpacs/write/vectors_4096", [](bench::state& state) { WriteCase(state, MakeVectors(4096)); });
+    BENCH_CASE("plakpacs/read/vectors_4096", [](bench::state& state) { ReadCase(state, MakeVectors(4096)); });
+
+    // Every number byte-swapped on the way, as for a big-endian peer
+    BENCH_CASE("plakpacs/write/vectors_4096_big_endian", [](bench::state& state) { WriteCase<Vectors, plakpacs::big_endian>(state, MakeVectors(4096)); });
+    BENCH_CASE("plakpacs/read/vectors_4096_big_endian", [](bench::state& state) { ReadCase<Vectors, plakpacs::big_endian>(state, MakeVectors(4096)); });
+
+    BENCH_CASE("plakpacs/write/strings", [](bench::state& state) { WriteCase(state, MakeStrings()); });
+    BENCH_CASE("plakpacs/read/strings", [](bench::state& state) { ReadCase(state, MakeStrings()); });
+
+    BENCH_CASE("plakpacs/read/validated", [](bench::state& state) { ReadCase(state, MakeValidated()); });
+    BENCH_CASE("plakpacs/read/validated_oversized", OversizedCase);
+
+    BENCH_CASE("plakpacs/write/optionals", [](bench::state& state) { WriteCase(state, MakeOptionals()); });
+    BENCH_CASE("plakpacs/read/optionals", [](bench::state& state) { ReadCase(state, MakeOptionals()); });
+}
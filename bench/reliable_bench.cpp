@@ -0,0 +1,149 @@
+//
+//  reliable_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+
+#include <gspp/network_impairment.hpp>
+#include <gspp/reliable_client.hpp>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace bench_reliable
+{
+    using Clock = gspp::ReliableEndpoint::Clock;
+
+    /// @brief Two endpoints talking through a simulated link each way, updated by hand the way a server tick would.
+    class ImpairedPair
+    {
+    public:
+        ImpairedPair(gspp::ReliableConfig config, gspp::ImpairmentSettings settings)
+            : _work(boost::asio::make_work_guard(_context)),
+              _toB(std::make_shared<gspp::NetworkImpairment>(_context.get_executor(), settings, 1)),
+              _toA(std::make_shared<gspp::NetworkImpairment>(_context.get_executor(), settings, 2))
+        {
+            a = std::make_unique<gspp::ReliableEndpoint>(
+                config,
+                [this](const uint8_t* data, std::size_t size)
+                {
+                    sent_payload += size - gspp::ReliableEndpoint::PacketHeaderSize;
+                    Transmit(*_toB, b, data, size);
+                },
+                [](std::size_t, bacs::shared_buffer&) {});
+
+            b = std::make_unique<gspp::ReliableEndpoint>(
+                config,
+                [this](const uint8_t* data, std::size_t size) { Transmit(*_toA, a, data, size); },
+                [this](std::size_t, bacs::shared_buffer& message)
+                {
+                    uint32_t value;
+                    std::memcpy(&value, message.data(), sizeof(value));
+
+                    in_order &= value == delivered;
+                    delivered++;
+                });
+        }
+
+        /// @brief Updates both endpoints and runs the links for a while.
+        void Tick()
+        {
+            auto now = Clock::now();
+            a->Update(now);
+            b->Update(now);
+
+            _context.run_for(std::chrono::microseconds(200));
+        }
+
+        std::unique_ptr<gspp::ReliableEndpoint> a;
+        std::unique_ptr<gspp::ReliableEndpoint> b;
+
+        std::size_t sent_payload = 0;
+        uint32_t delivered = 0;
+        bool in_order = true;
+
+    private:
+        void Transmit(gspp::NetworkImpairment& link, std::unique_ptr<gspp::ReliableEndpoint>& to, const uint8_t* data, std::size_t size)
+        {
+            bacs::shared_buffer packet{ size };
+            std::memcpy(packet.data(), data, size);
+
+            link.Submit(size, [&to, packet, size] { to->ReceivePacket(packet, 0, size); });
+        }
+
+        boost::asio::io_context _context;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> _work;
+        std::shared_ptr<gspp::NetworkImpairment> _toB;
+        std::shared_ptr<gspp::NetworkImpairment> _toA;
+    };
+
+    // Not a tight loop: each operation is a whole transfer over a link with real latency, so this mostly checks
+    // that lost messages are resent and delivered in order, and that keepalives hold an idle link open afterwards
+    void TransferCase(bench::state& state, double loss)
+    {
+        constexpr uint32_t messages = 256;
+
+        gspp::ReliableConfig config;
+        config.resend_interval = std::chrono::milliseconds(20);
+        config.timeout = std::chrono::milliseconds(100);
+        config.keepalive_interval = std::chrono::milliseconds(20);
+
+        gspp::ImpairmentSettings settings;
+        settings.latency = std::chrono::microseconds(1000);
+        settings.jitter = std::chrono::microseconds(500);
+        settings.loss = loss;
+        settings.reorder = loss / 2;
+        settings.duplicate = loss / 2;
+
+        ImpairedPair pair{ config, settings };
+
+        uint32_t next = 0;
+        std::size_t operations = 0;
+
+        state.run([&]
+        {
+            for (uint32_t i = 0; i < messages; i++, next++)
+                pair.a->SendMessage(0, reinterpret_cast<const uint8_t*>(&next), sizeof(next));
+
+            auto deadline = Clock::now() + std::chrono::seconds(5);
+
+            while (pair.delivered != next)
+            {
+                if (Clock::now() > deadline)
+                    throw std::runtime_error("reliable transfer: messages were never delivered");
+
+                pair.Tick();
+            }
+
+            operations++;
+        });
+
+        if (!pair.in_order)
+            throw std::runtime_error("reliable transfer: messages were delivered out of order");
+
+        // Every message costs its header and value once; whatever went out on top of that was resent
+        auto once = (double)(gspp::ReliableEndpoint::MessageHeaderSize + sizeof(uint32_t)) * next;
+        auto resent = ((double)pair.sent_payload - once) / (gspp::ReliableEndpoint::MessageHeaderSize + sizeof(uint32_t)) / operations;
+
+        if (loss > 0 && resent <= 0)
+            throw std::runtime_error("reliable transfer: nothing was resent over a lossy link");
+
+        state.set_items_per_op(messages);
+        state.set_counter("resent_per_op", resent);
+
+        auto idleUntil = Clock::now() + 4 * config.timeout;
+        while (Clock::now() < idleUntil)
+            pair.Tick();
+
+        auto now = Clock::now();
+        if (now - pair.a->last_receive_time() > config.timeout || now - pair.b->last_receive_time() > config.timeout)
+            throw std::runtime_error("reliable transfer: an idle link timed out");
+    }
+
+    BENCH_CASE("reliable/impaired_transfer/256_lossless", [](bench::state& state) { TransferCase(state, 0.0); });
+    BENCH_CASE("reliable/impaired_transfer/256_loss_10", [](bench::state& state) { TransferCase(state, 0.1); });
+}
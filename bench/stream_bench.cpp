@@ -0,0 +1,94 @@
+//
+//  stream_bench.cpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#include "bench.hpp"
+
+#include <gspp/prepared_packet.hpp>
+#include <gspp/stream_client.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace bench_stream
+{
+    using Protocol = boost::asio::local::stream_protocol;
+
+    // Frames sent by one StreamClient and handled by the receive loop of another, each one sent once the one before it
+    // is in. The write and read chains run on handler memory and frames are read into the connection's pool, while the
+    // executor_functions asio needs come from its per-thread recycling allocator once the context is running. What's
+    // left is a node of the write queue's deque now and then.
+    void RoundTripCase(bench::state& state, std::size_t size)
+    {
+        constexpr std::size_t RoundTrips = 100;
+#if defined(BOOST_ASIO_HAS_CO_AWAIT) && !defined(GSPP_NO_COROUTINES)
+        // Boost 1.74 keeps one coroutine frame per thread for reuse, so read_frame's frame and the one of the read under
+        // it push each other out: two allocations a frame, neither of them the frame's buffer
+        constexpr double MaxAllocations = 2.1;
+#else
+        constexpr double MaxAllocations = 0.1;
+#endif
+
+        boost::asio::io_context context;
+        Protocol::socket writerSocket{ context };
+        Protocol::socket readerSocket{ context };
+        boost::asio::local::connect_pair(writerSocket, readerSocket);
+
+        std::vector<uint8_t> bytes(size, 0x42);
+        gspp::PreparedPacket packet{ bytes.data(), bytes.size() };
+
+        std::size_t remaining = 0;
+        std::size_t received = 0;
+
+        gspp::StreamClient<Protocol> writer{ std::move(writerSocket) };
+
+        // The receive loop never runs out of work, so the handler stops the context after the last frame
+        gspp::StreamClient<Protocol> reader{ std::move(readerSocket),
+            [&](bacs::shared_buffer& buffer)
+            {
+                received += buffer.size();
+
+                if (--remaining)
+                    writer.Send(packet);
+                else
+                    context.stop();
+
+                return true;
+            } };
+
+        reader.StartReceiveLoop();
+        state.set_bytes_per_op((double)(size * RoundTrips));
+        state.set_items_per_op(RoundTrips);
+
+        auto roundTrips = [&]
+        {
+            remaining = RoundTrips;
+            received = 0;
+            writer.Send(packet);
+
+            context.restart();
+            context.run();
+
+            if (received != size * RoundTrips)
+                throw std::runtime_error("stream round trip: short frame");
+        };
+
+        state.run(roundTrips);
+
+        auto allocations = bench::allocations_per_op(roundTrips, 100) / RoundTrips;
+        state.set_counter("allocs_per_frame", allocations);
+
+        if (allocations > MaxAllocations)
+            throw std::runtime_error("stream round trip: frames allocated more than the StreamClient's pools and asio's recycling leave");
+    }
+
+    BENCH_CASE("stream/round_trip/64", [](bench::state& state) { RoundTripCase(state, 64); });
+    BENCH_CASE("stream/round_trip/1024", [](bench::state& state) { RoundTripCase(state, 1024); });
+}
+
+#endif
@@ -0,0 +1,432 @@
+//
+//  types.hpp
+//  bench
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bpacs/bpacs.hpp>
+#include <plakpacs/plakpacs.hpp>
+#include <plakpacs/validators.hpp>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Representative reflected types shared by the benchmark suites
+
+namespace bench_types
+{
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    struct FlatPod
+    {
+        uint32_t id;
+        uint64_t timestamp;
+        float health;
+        double score;
+        uint8_t flags;
+        int16_t level;
+    };
+
+    struct Nested
+    {
+        FlatPod pod;
+        Vec3 position;
+        Vec3 velocity;
+        Vec3 rotation;
+    };
+
+    struct Vectors
+    {
+        plakpacs::sp_vector<uint32_t> ids;
+        plakpacs::sp_vector<Vec3> points;
+    };
+
+    struct Strings
+    {
+        plakpacs::sp_string name;
+        plakpacs::sp_string description;
+        plakpacs::sp_vector<plakpacs::sp_string> tags;
+    };
+
+    struct Optionals
+    {
+        std::optional<uint32_t> target;
+        std::optional<Vec3> destination;
+        std::optional<plakpacs::sp_string> message;
+    };
+
+    struct JsonItem
+    {
+        uint32_t id;
+        std::string name;
+        double weight;
+        std::vector<std::string> tags;
+    };
+
+    struct JsonRecord
+    {
+        uint64_t id;
+        std::string name;
+        bool active;
+        double balance;
+        std::vector<uint32_t> scores;
+        std::vector<JsonItem> items;
+        std::optional<std::string> note;
+        std::map<std::string, int64_t> attributes;
+        JsonItem primary;
+    };
+
+    struct NestedContainers
+    {
+        std::vector<std::vector<std::string>> grid;
+        std::map<std::string, std::vector<JsonItem>> groups;
+        std::vector<std::optional<JsonItem>> slots;
+    };
+
+    // What a gateway passes between web clients, as JSON, and game servers, as plakpacs
+    struct GatewayItem
+    {
+        uint32_t id;
+        std::string name;
+        uint16_t count;
+        double weight;
+    };
+
+    struct GatewayMessage
+    {
+        uint64_t id;
+        std::string sender;
+        bool urgent;
+        Vec3 position;
+        plakpacs::sp_vector<uint32_t> targets;
+        plakpacs::sp_vector<GatewayItem> items;
+        std::optional<std::string> note;
+    };
+
+    // The same wire format as GatewayMessage, decoded into plakpacs::pmr containers
+    struct PmrGatewayItem
+    {
+        uint32_t id;
+        plakpacs::pmr::string name;
+        uint16_t count;
+        double weight;
+    };
+
+    struct PmrGatewayMessage
+    {
+        uint64_t id;
+        plakpacs::pmr::string sender;
+        bool urgent;
+        Vec3 position;
+        plakpacs::pmr::sp_vector<uint32_t> targets;
+        plakpacs::pmr::sp_vector<PmrGatewayItem> items;
+        std::optional<plakpacs::pmr::string> note;
+    };
+
+    // Untrusted input with the usual limits on it
+    struct Validated
+    {
+        plakpacs::constrained<plakpacs::sp_vector<uint16_t>, plakpacs::max_container_size<4096>, plakpacs::element_range<0, 1000>> levels;
+        plakpacs::constrained<plakpacs::sp_string, plakpacs::max_container_size<256>, plakpacs::valid_utf8> name;
+    };
+
+    // Wide enough that looking every field up by name shows
+    struct WideRecord
+    {
+        uint32_t field_00;
+        uint32_t field_01;
+        uint32_t field_02;
+        uint32_t field_03;
+        uint32_t field_04;
+        uint32_t field_05;
+        uint32_t field_06;
+        uint32_t field_07;
+        uint32_t field_08;
+        uint32_t field_09;
+        uint32_t field_10;
+        uint32_t field_11;
+        uint32_t field_12;
+        uint32_t field_13;
+        uint32_t field_14;
+        uint32_t field_15;
+        uint32_t field_16;
+        uint32_t field_17;
+        uint32_t field_18;
+        uint32_t field_19;
+        uint32_t field_20;
+        uint32_t field_21;
+        uint32_t field_22;
+        uint32_t field_23;
+        uint32_t field_24;
+        uint32_t field_25;
+        uint32_t field_26;
+        uint32_t field_27;
+        uint32_t field_28;
+        uint32_t field_29;
+        uint32_t field_30;
+        uint32_t field_31;
+        uint32_t field_32;
+        uint32_t field_33;
+        uint32_t field_34;
+        uint32_t field_35;
+        uint32_t field_36;
+        uint32_t field_37;
+        uint32_t field_38;
+        uint32_t field_39;
+        uint32_t field_40;
+        uint32_t field_41;
+        uint32_t field_42;
+        uint32_t field_43;
+        uint32_t field_44;
+        uint32_t field_45;
+        uint32_t field_46;
+        uint32_t field_47;
+        uint32_t field_48;
+        uint32_t field_49;
+    };
+
+    inline FlatPod MakeFlatPod(uint32_t i = 1)
+    {
+        return { i, 1697040000000ull + i, 87.5f, 1234.5678 * i, 0x5A, (int16_t)(i % 100) };
+    }
+
+    inline Nested MakeNested(uint32_t i = 1)
+    {
+        return { MakeFlatPod(i), { 1.f, 2.f, 3.f }, { 0.1f, 0.2f, 0.3f }, { 0.f, 90.f, 0.f } };
+    }
+
+    inline Vectors MakeVectors(std::size_t n = 64)
+    {
+        Vectors v;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            v.ids.push_back((uint32_t)i * 7);
+            v.points.push_back({ (float)i, (float)i * 2, (float)i * 3 });
+        }
+        return v;
+    }
+
+    inline Strings MakeStrings()
+    {
+        Strings s;
+        s.name = "Sir Reginald Featherstonehaugh";
+        s.description = "A moderately long description string, the kind that shows up in item and quest data.";
+        for (int i = 0; i < 8; i++)
+            s.tags.push_back("tag-" + std::to_string(i));
+        return s;
+    }
+
+    inline Validated MakeValidated(std::size_t n = 1024)
+    {
+        Validated v;
+        for (std::size_t i = 0; i < n; i++)
+            v.levels.push_back((uint16_t)(i % 1000));
+        v.name.assign("Sir Reginald Featherstonehaugh, \xC3\x9C" "berwald");
+        return v;
+    }
+
+    inline Optionals MakeOptionals()
+    {
+        Optionals o;
+        o.target = 42;
+        o.destination = Vec3{ 10.f, 0.f, -5.f };
+        o.message = plakpacs::sp_string("Meet at the gate");
+        return o;
+    }
+
+    inline JsonItem MakeJsonItem(uint32_t i)
+    {
+        return { i, "item-" + std::to_string(i), 0.25 * i, { "common", "stackable", "tradeable" } };
+    }
+
+    inline NestedContainers MakeNestedContainers()
+    {
+        NestedContainers n;
+        n.grid.resize(16);
+        for (uint32_t row = 0; row < 16; row++)
+            for (uint32_t column = 0; column < 16; column++)
+                n.grid[row].push_back("cell-" + std::to_string(row) + "-" + std::to_string(column) + "-with-some-padding");
+        for (uint32_t group = 0; group < 8; group++)
+            for (uint32_t k = 0; k < 8; k++)
+                n.groups["group-" + std::to_string(group)].push_back(MakeJsonItem(group * 8 + k));
+        for (uint32_t k = 0; k < 16; k++)
+            n.slots.push_back(k % 3 ? std::optional<JsonItem>(MakeJsonItem(k)) : std::nullopt);
+        return n;
+    }
+
+    inline GatewayMessage MakeGatewayMessage(uint32_t i = 1)
+    {
+        GatewayMessage m;
+        m.id = 500000 + i;
+        m.sender = "player-" + std::to_string(i);
+        m.urgent = (i % 5) == 0;
+        m.position = { 12.5f, -3.f, 140.25f };
+        for (uint32_t k = 0; k < 8; k++)
+            m.targets.push_back(k * 31 + i);
+        for (uint32_t k = 0; k < 6; k++)
+            m.items.push_back({ k, "item-" + std::to_string(k), (uint16_t)(k + 1), 0.5 * k });
+        m.note = "trade request";
+        return m;
+    }
+
+    inline JsonRecord MakeJsonRecord(uint32_t i = 1)
+    {
+        JsonRecord r;
+        r.id = 100000 + i;
+        r.name = "record-" + std::to_string(i);
+        r.active = (i % 2) == 0;
+        r.balance = 9876.54321 * i;
+        for (uint32_t k = 0; k < 16; k++)
+            r.scores.push_back(k * 13 + i);
+        for (uint32_t k = 0; k < 8; k++)
+            r.items.push_back(MakeJsonItem(k));
+        r.note = "no comment";
+        r.attributes = { { "strength", 12 }, { "agility", 17 }, { "wisdom", 9 } };
+        r.primary = MakeJsonItem(99);
+        return r;
+    }
+}
+
+BP_DEFINE_REFL_FIELD(bench_types::Vec3, 0, x)
+BP_DEFINE_REFL_FIELD(bench_types::Vec3, 1, y)
+BP_DEFINE_REFL_FIELD(bench_types::Vec3, 2, z)
+
+BP_DEFINE_REFL_FIELD(bench_types::FlatPod, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::FlatPod, 1, timestamp)
+BP_DEFINE_REFL_FIELD(bench_types::FlatPod, 2, health)
+BP_DEFINE_REFL_FIELD(bench_types::FlatPod, 3, score)
+BP_DEFINE_REFL_FIELD(bench_types::FlatPod, 4, flags)
+BP_DEFINE_REFL_FIELD(bench_types::FlatPod, 5, level)
+
+BP_DEFINE_REFL_FIELD(bench_types::Nested, 0, pod)
+BP_DEFINE_REFL_FIELD(bench_types::Nested, 1, position)
+BP_DEFINE_REFL_FIELD(bench_types::Nested, 2, velocity)
+BP_DEFINE_REFL_FIELD(bench_types::Nested, 3, rotation)
+
+BP_DEFINE_REFL_FIELD(bench_types::Vectors, 0, ids)
+BP_DEFINE_REFL_FIELD(bench_types::Vectors, 1, points)
+
+BP_DEFINE_REFL_FIELD(bench_types::Strings, 0, name)
+BP_DEFINE_REFL_FIELD(bench_types::Strings, 1, description)
+BP_DEFINE_REFL_FIELD(bench_types::Strings, 2, tags)
+
+BP_DEFINE_REFL_FIELD(bench_types::Optionals, 0, target)
+BP_DEFINE_REFL_FIELD(bench_types::Optionals, 1, destination)
+BP_DEFINE_REFL_FIELD(bench_types::Optionals, 2, message)
+
+BP_DEFINE_REFL_FIELD(bench_types::JsonItem, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::JsonItem, 1, name)
+BP_DEFINE_REFL_FIELD(bench_types::JsonItem, 2, weight)
+BP_DEFINE_REFL_FIELD(bench_types::JsonItem, 3, tags)
+
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 1, name)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 2, active)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 3, balance)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 4, scores)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 5, items)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 6, note)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 7, attributes)
+BP_DEFINE_REFL_FIELD(bench_types::JsonRecord, 8, primary)
+
+BP_DEFINE_REFL_FIELD(bench_types::NestedContainers, 0, grid)
+BP_DEFINE_REFL_FIELD(bench_types::NestedContainers, 1, groups)
+BP_DEFINE_REFL_FIELD(bench_types::NestedContainers, 2, slots)
+
+BP_DEFINE_REFL_FIELD(bench_types::GatewayItem, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayItem, 1, name)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayItem, 2, count)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayItem, 3, weight)
+
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 1, sender)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 2, urgent)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 3, position)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 4, targets)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 5, items)
+BP_DEFINE_REFL_FIELD(bench_types::GatewayMessage, 6, note)
+
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayItem, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayItem, 1, name)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayItem, 2, count)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayItem, 3, weight)
+
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 0, id)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 1, sender)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 2, urgent)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 3, position)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 4, targets)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 5, items)
+BP_DEFINE_REFL_FIELD(bench_types::PmrGatewayMessage, 6, note)
+
+BP_DEFINE_REFL_FIELD(bench_types::Validated, 0, levels)
+BP_DEFINE_REFL_FIELD(bench_types::Validated, 1, name)
+
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 0, field_00)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 1, field_01)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 2, field_02)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 3, field_03)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 4, field_04)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 5, field_05)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 6, field_06)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 7, field_07)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 8, field_08)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 9, field_09)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 10, field_10)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 11, field_11)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 12, field_12)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 13, field_13)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 14, field_14)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 15, field_15)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 16, field_16)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 17, field_17)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 18, field_18)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 19, field_19)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 20, field_20)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 21, field_21)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 22, field_22)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 23, field_23)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 24, field_24)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 25, field_25)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 26, field_26)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 27, field_27)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 28, field_28)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 29, field_29)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 30, field_30)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 31, field_31)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 32, field_32)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 33, field_33)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 34, field_34)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 35, field_35)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 36, field_36)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 37, field_37)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 38, field_38)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 39, field_39)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 40, field_40)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 41, field_41)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 42, field_42)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 43, field_43)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 44, field_44)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 45, field_45)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 46, field_46)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 47, field_47)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 48, field_48)
+BP_DEFINE_REFL_FIELD(bench_types::WideRecord, 49, field_49)
+
+namespace bench_types
+{
+    // Defined after the fields, which it walks through
+    inline WideRecord MakeWideRecord()
+    {
+        WideRecord w;
+        bpacs::iterate_object(w, [](auto field) { field.value() = (uint32_t)(field.index() * 1000 + 7); });
+        return w;
+    }
+}
@@ -0,0 +1,197 @@
+//
+//  arena.hpp
+//  bpacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+namespace bpacs
+{
+	/// @brief A bump allocator for object graphs that all die at the same time, such as a decoded packet.
+	/// Deallocation does nothing; memory is only given back by rewinding to an earlier mark or resetting the arena,
+	/// which keeps its chunks around so that the next graph of the same shape allocates nothing from the heap.
+	/// Not thread-safe: use one arena per thread.
+	class arena : public std::pmr::memory_resource
+	{
+	public:
+		/// @brief A position in the arena to rewind to.
+		struct marker
+		{
+			std::size_t chunk = 0;
+			std::size_t offset = 0;
+		};
+
+		explicit arena(std::size_t chunk_size = 16 * 1024)
+		: _chunk_size(std::max<std::size_t>(chunk_size, 64))
+		{}
+
+		arena(const arena&) = delete;
+		arena& operator=(const arena&) = delete;
+
+		marker mark() const { return { _current, _offset }; }
+
+		/// @brief Frees everything allocated since the mark was taken. Marks taken after it become invalid.
+		void rewind(marker mark)
+		{
+			_current = mark.chunk;
+			_offset = mark.offset;
+		}
+
+		/// @brief Frees everything at once, keeping the chunks for later.
+		void reset() { rewind({}); }
+
+		/// @brief How many bytes the arena holds in its chunks, used or not.
+		std::size_t capacity() const
+		{
+			std::size_t total = 0;
+			for(auto& chunk : _chunks)
+				total += chunk.size;
+
+			return total;
+		}
+
+	private:
+		struct chunk
+		{
+			std::unique_ptr<std::byte[]> data;
+			std::size_t size;
+		};
+
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			for(;;)
+			{
+				if(_current == _chunks.size())
+					grow(bytes + alignment);
+
+				auto& chunk = _chunks[_current];
+				auto base = reinterpret_cast<std::uintptr_t>(chunk.data.get());
+				auto aligned = (base + _offset + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+
+				if(aligned + bytes <= base + chunk.size)
+				{
+					_offset = aligned + bytes - base;
+					return reinterpret_cast<void*>(aligned);
+				}
+
+				// Too small for this one; chunks never shrink, so the next one is worth a try
+				_current++;
+				_offset = 0;
+			}
+		}
+
+		void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		void grow(std::size_t at_least)
+		{
+			// Doubling stops at max_chunk_size, but never below an oversized chunk before it
+			auto size = _chunks.empty() ? _chunk_size : std::max(_chunks.back().size, std::min(_chunks.back().size * 2, max_chunk_size));
+			size = std::max(size, at_least);
+
+			_chunks.push_back({ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+		}
+
+		static constexpr std::size_t max_chunk_size = 1024 * 1024;
+
+		std::size_t _chunk_size;
+		std::vector<chunk> _chunks;
+		std::size_t _current = 0;
+		std::size_t _offset = 0;
+	};
+
+	/// @brief Rewinds an arena to where it was when the checkpoint was created, once it goes out of scope.
+	class arena_checkpoint
+	{
+	public:
+		explicit arena_checkpoint(arena& arena)
+		: _arena(&arena), _mark(arena.mark())
+		{}
+
+		~arena_checkpoint() { _arena->rewind(_mark); }
+
+		arena_checkpoint(const arena_checkpoint&) = delete;
+		arena_checkpoint& operator=(const arena_checkpoint&) = delete;
+
+	private:
+		arena* _arena;
+		arena::marker _mark;
+	};
+
+	namespace detail
+	{
+		inline std::pmr::memory_resource*& current_resource_slot()
+		{
+			thread_local std::pmr::memory_resource* resource = nullptr;
+			return resource;
+		}
+	}
+
+	/// @brief The resource arena_allocator picks up when it's default-constructed on this thread: the one of the
+	/// innermost arena_scope, or the heap outside of any.
+	inline std::pmr::memory_resource* current_resource()
+	{
+		auto resource = detail::current_resource_slot();
+		return resource ? resource : std::pmr::get_default_resource();
+	}
+
+	/// @brief Makes a resource the current one on this thread for as long as the scope lives.
+	class arena_scope
+	{
+	public:
+		explicit arena_scope(std::pmr::memory_resource& resource)
+		: _previous(std::exchange(detail::current_resource_slot(), &resource))
+		{}
+
+		~arena_scope() { detail::current_resource_slot() = _previous; }
+
+		arena_scope(const arena_scope&) = delete;
+		arena_scope& operator=(const arena_scope&) = delete;
+
+	private:
+		std::pmr::memory_resource* _previous;
+	};
+
+	/// @brief A polymorphic allocator that defaults to current_resource() instead of the global default, so that
+	/// containers a deserializer creates inside an arena_scope land in the arena without being told about it.
+	/// Elements of such containers share their parent's resource. Copies go to the heap, so whatever outlives
+	/// the arena has to be copied out of it, not moved.
+	template<class T>
+	class arena_allocator : public std::pmr::polymorphic_allocator<T>
+	{
+	public:
+		arena_allocator() noexcept
+		: std::pmr::polymorphic_allocator<T>(current_resource())
+		{}
+
+		arena_allocator(std::pmr::memory_resource* resource) noexcept
+		: std::pmr::polymorphic_allocator<T>(resource)
+		{}
+
+		template<class U>
+		arena_allocator(const std::pmr::polymorphic_allocator<U>& other) noexcept
+		: std::pmr::polymorphic_allocator<T>(other.resource())
+		{}
+
+		arena_allocator(const arena_allocator& other) = default;
+
+		arena_allocator select_on_container_copy_construction() const
+		{
+			return arena_allocator(std::pmr::get_default_resource());
+		}
+	};
+}
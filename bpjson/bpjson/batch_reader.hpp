@@ -0,0 +1,329 @@
+//
+//  batch_reader.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "sax_reader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bpjson
+{
+    enum class batch_format
+    {
+        /// @brief One record per line; blank lines are skipped.
+        ndjson,
+
+        /// @brief A single top-level array of records.
+        array
+    };
+
+    struct batch_error
+    {
+        /// @brief The record's position in the output.
+        std::size_t index;
+
+        /// @brief Where the record starts in the input.
+        std::size_t offset;
+
+        std::string message;
+    };
+
+    /// @brief Decodes many records at once across threads. The input is first split into records with a quick scan
+    /// of its structure, then decoded in chunks by sax_reader, one per thread, into the output vector in input order.
+    /// A record that fails is left value-initialized and reported on its own; the rest of the batch goes on.
+    template <class Json>
+    class batch_reader
+    {
+    public:
+        explicit batch_reader(const serialization_settings &settings = {}, std::size_t records_per_task = 256)
+            : _settings(settings), _records_per_task(std::max<std::size_t>(records_per_task, 1))
+        {
+        }
+
+        /// @brief Decodes on the calling thread and threads - 1 threads of its own (0: one per hardware thread).
+        /// @return The records that failed, by index
+        template <class T>
+        std::vector<batch_error> read_to(std::string_view input, batch_format format, std::vector<T> &out,
+                                         unsigned threads = 0)
+        {
+            if (threads == 0)
+                threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+            auto state = start(input, format, out);
+            auto helpers = std::min<std::size_t>(threads - 1, state->chunks ? state->chunks - 1 : 0);
+
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < helpers; i++)
+                workers.emplace_back([state] { work(*state); });
+
+            work(*state);
+
+            for (auto &worker : workers)
+                worker.join();
+
+            return finish(*state);
+        }
+
+        /// @brief Decodes on the calling thread and on whatever dispatch(std::function<void()> task) runs the tasks on,
+        /// e.g. [&context](auto task) { boost::asio::post(context, std::move(task)); } for an io_worker_pool's context.
+        /// The calling thread takes chunks too, so this finishes even if the tasks never get to run before it returns;
+        /// late tasks find nothing left and return right away.
+        template <class T, class Dispatch,
+                  std::enable_if_t<std::is_invocable_v<Dispatch &, std::function<void()>>, int> = 0>
+        std::vector<batch_error> read_to(std::string_view input, batch_format format, std::vector<T> &out,
+                                         Dispatch &&dispatch)
+        {
+            auto state = start(input, format, out);
+
+            for (std::size_t i = 1; i < state->chunks; i++)
+                dispatch(std::function<void()>([state] { work(*state); }));
+
+            work(*state);
+            state->wait();
+            return finish(*state);
+        }
+
+        /// @brief Splits the input into the text of its records, without decoding them.
+        /// @return Each record's offset and size
+        static std::vector<std::pair<std::size_t, std::size_t>> split(std::string_view input, batch_format format)
+        {
+            return format == batch_format::ndjson ? split_lines(input) : split_array(input);
+        }
+
+    private:
+        struct state_base
+        {
+            std::string_view input;
+            std::vector<std::pair<std::size_t, std::size_t>> records;
+            serialization_settings settings;
+            std::size_t records_per_task = 0;
+            std::size_t chunks = 0;
+
+            std::atomic<std::size_t> next_chunk = 0;
+            std::atomic<std::size_t> remaining = 0;
+            std::mutex mutex;
+            std::condition_variable done;
+
+            std::vector<batch_error> errors;
+
+            // Decodes one chunk; set by start() for the output type
+            void (*decode)(state_base &, std::size_t chunk, sax_reader<Json> &, std::vector<batch_error> &) = nullptr;
+            void *out = nullptr;
+
+            void wait()
+            {
+                std::unique_lock lock(mutex);
+                done.wait(lock, [this] { return remaining.load(std::memory_order_acquire) == 0; });
+            }
+        };
+
+        template <class T>
+        std::shared_ptr<state_base> start(std::string_view input, batch_format format, std::vector<T> &out)
+        {
+            auto state = std::make_shared<state_base>();
+            state->input = input;
+            state->records = split(input, format);
+            state->settings = _settings;
+            state->records_per_task = _records_per_task;
+            state->chunks = (state->records.size() + _records_per_task - 1) / _records_per_task;
+            state->remaining = state->chunks;
+            state->decode = &decode_chunk<T>;
+            state->out = &out;
+
+            out.clear();
+            out.resize(state->records.size());
+            return state;
+        }
+
+        template <class T>
+        static void decode_chunk(state_base &state, std::size_t chunk, sax_reader<Json> &reader,
+                                 std::vector<batch_error> &errors)
+        {
+            auto &out = *static_cast<std::vector<T> *>(state.out);
+            auto first = chunk * state.records_per_task;
+            auto last = std::min(first + state.records_per_task, state.records.size());
+
+            for (auto i = first; i < last; i++)
+            {
+                auto [offset, size] = state.records[i];
+
+                try
+                {
+                    reader.read_to(state.input.substr(offset, size), out[i]);
+                }
+                catch (const std::exception &e)
+                {
+                    out[i] = T{};
+                    errors.push_back({i, offset, e.what()});
+                }
+            }
+        }
+
+        static void work(state_base &state)
+        {
+            sax_reader<Json> reader(state.settings);
+            std::vector<batch_error> errors;
+
+            for (;;)
+            {
+                auto chunk = state.next_chunk.fetch_add(1, std::memory_order_relaxed);
+
+                if (chunk >= state.chunks)
+                    break;
+
+                state.decode(state, chunk, reader, errors);
+
+                if (!errors.empty())
+                {
+                    std::lock_guard lock(state.mutex);
+                    state.errors.insert(state.errors.end(), std::make_move_iterator(errors.begin()),
+                                        std::make_move_iterator(errors.end()));
+                    errors.clear();
+                }
+
+                if (state.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard lock(state.mutex);
+                    state.done.notify_all();
+                }
+            }
+        }
+
+        static std::vector<batch_error> finish(state_base &state)
+        {
+            std::lock_guard lock(state.mutex);
+
+            auto errors = std::move(state.errors);
+            std::sort(errors.begin(), errors.end(), [](auto &a, auto &b) { return a.index < b.index; });
+            return errors;
+        }
+
+        static bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        static std::vector<std::pair<std::size_t, std::size_t>> split_lines(std::string_view input)
+        {
+            std::vector<std::pair<std::size_t, std::size_t>> records;
+            std::size_t start = 0;
+
+            while (start < input.size())
+            {
+                auto end = input.find('\n', start);
+                if (end == std::string_view::npos)
+                    end = input.size();
+
+                auto line = input.substr(start, end - start);
+                if (std::any_of(line.begin(), line.end(), [](char c) { return !is_space(c); }))
+                    records.emplace_back(start, line.size());
+
+                start = end + 1;
+            }
+
+            return records;
+        }
+
+        // Only brackets, braces, commas and strings matter here; the records themselves are checked when they're decoded
+        static std::vector<std::pair<std::size_t, std::size_t>> split_array(std::string_view input)
+        {
+            std::vector<std::pair<std::size_t, std::size_t>> records;
+
+            auto skip_space = [&input](std::size_t position) {
+                while (position < input.size() && is_space(input[position]))
+                    position++;
+
+                return position;
+            };
+
+            auto position = skip_space(0);
+            if (position == input.size() || input[position] != '[')
+                throw std::runtime_error("bpjson::batch_reader.split: expected a top-level array");
+
+            position = skip_space(position + 1);
+            if (position < input.size() && input[position] == ']')
+            {
+                if (skip_space(position + 1) != input.size())
+                    throw std::runtime_error("bpjson::batch_reader.split: unexpected data after the array");
+
+                return records;
+            }
+
+            auto start = position;
+            std::size_t depth = 0;
+            bool in_string = false;
+
+            for (; position < input.size(); position++)
+            {
+                auto c = input[position];
+
+                if (in_string)
+                {
+                    if (c == '\\')
+                        position++;
+                    else if (c == '"')
+                        in_string = false;
+
+                    continue;
+                }
+
+                switch (c)
+                {
+                case '"':
+                    in_string = true;
+                    break;
+                case '{':
+                case '[':
+                    depth++;
+                    break;
+                case '}':
+                case ']':
+                    if (depth == 0)
+                    {
+                        if (c != ']')
+                            throw std::runtime_error("bpjson::batch_reader.split: unbalanced '}' at offset " +
+                                                     std::to_string(position));
+
+                        records.emplace_back(start, position - start);
+
+                        if (skip_space(position + 1) != input.size())
+                            throw std::runtime_error("bpjson::batch_reader.split: unexpected data after the array");
+
+                        return records;
+                    }
+
+                    depth--;
+                    break;
+                case ',':
+                    if (depth == 0)
+                    {
+                        records.emplace_back(start, position - start);
+                        start = position + 1;
+                    }
+                    break;
+                }
+            }
+
+            throw std::runtime_error("bpjson::batch_reader.split: unterminated array");
+        }
+
+        serialization_settings _settings;
+        std::size_t _records_per_task;
+    };
+} // namespace bpjson
@@ -7,7 +7,10 @@
 //
 
 #pragma once
+#include "field_table.hpp"
+#include "value_kind.hpp"
 #include <bpacs/bpacs.hpp>
+#include <array>
 #include <map>
 #include <optional>
 #include <stdexcept>
@@ -53,10 +56,16 @@ namespace bpjson
             return json[key];
         }
 
-        static const void copy(json_type &to, const json_type &from)
+        static void copy(json_type &to, const json_type &from)
         {
             to = from;
         }
+
+        /// @brief What the container walkers iterate over to get an array's elements.
+        static const json_type &get_elements(const json_type &json)
+        {
+            return json;
+        }
     };
 
     template <std::size_t KeyIndex, std::size_t ValueIndex>
@@ -123,32 +132,43 @@ namespace bpjson
         template <class T>
         static void read_object(const Json &json, T &object, const serialization_settings &settings = {})
         {
-            bpacs::iterate_object(object, [&json, &settings](auto field) {
-                try
-                {
-                    if ((settings.missing_fields_mode == missing_fields::throw_exception &&
-                         !json_walker<Json, T>::force_optional && !json_fields_optional<T>::value) ||
-                        json_traits<Json>::subkey_exists(json, field.name()))
-                    {
-                        json_serializer<Json>::read_to(json_traits<Json>::get_existing_subkey(json, field.name()),
-                                                       field.value(), settings);
-                    }
-                    else
-                    {
-                        if (settings.missing_fields_mode == missing_fields::default_initialize)
-                            field.value() = {};
-                    }
-                }
-                catch (const std::exception &e)
-                {
-                    throw std::runtime_error(std::string("bpjson::json_serializer.read_object: field '") +
-                                             field.name() + "' caught exception - " + e.what());
-                }
-                catch (...)
-                {
-                    throw std::runtime_error(std::string("bpjson::json_serializer.read_object: field '") +
-                                             field.name() + "' caught unknown exception");
-                }
+            if (!json_traits<Json>::is_object(json))
+            {
+                read_object_fields(json, object, settings);
+                return;
+            }
+
+            // One pass over the keys that are there, each matched to its field through the sorted name table
+            std::array<bool, field_table<T>::size> seen{};
+
+            for (auto &&kv : json_traits<Json>::get_keys(json))
+            {
+                auto entry = field_table<T>::find(json_traits<Json>::get_kp_key(kv));
+
+                if (!entry)
+                    continue;
+
+                seen[entry->index] = true;
+
+                visit_field(object, entry->index, [&kv, &settings](auto field) {
+                    read_field(field, [&] {
+                        json_serializer<Json>::read_to(json_traits<Json>::get_kp_value(kv), field.value(), settings);
+                    });
+                });
+            }
+
+            bpacs::iterate_object(object, [&seen, &settings](auto field) {
+                if (seen[field.index()])
+                    return;
+
+                read_field(field, [&] {
+                    if (settings.missing_fields_mode == missing_fields::throw_exception &&
+                        !json_walker<Json, T>::force_optional && !json_fields_optional<T>::value)
+                        throw std::runtime_error("key not found");
+
+                    if (settings.missing_fields_mode == missing_fields::default_initialize)
+                        field.value() = {};
+                });
             });
         }
 
@@ -189,19 +209,75 @@ namespace bpjson
             write_from(json, value, settings);
             return json;
         }
+
+    private:
+        template <class Field, class F>
+        static void read_field(Field &field, F &&read)
+        {
+            try
+            {
+                read();
+            }
+            catch (const std::exception &e)
+            {
+                throw std::runtime_error(std::string("bpjson::json_serializer.read_object: field '") + field.name() +
+                                         "' caught exception - " + e.what());
+            }
+            catch (...)
+            {
+                throw std::runtime_error(std::string("bpjson::json_serializer.read_object: field '") + field.name() +
+                                         "' caught unknown exception");
+            }
+        }
+
+        // Looks every field up by name. Only used when the value isn't an object
+        template <class T>
+        static void read_object_fields(const Json &json, T &object, const serialization_settings &settings)
+        {
+            bpacs::iterate_object(object, [&json, &settings](auto field) {
+                read_field(field, [&] {
+                    if ((settings.missing_fields_mode == missing_fields::throw_exception &&
+                         !json_walker<Json, T>::force_optional && !json_fields_optional<T>::value) ||
+                        json_traits<Json>::subkey_exists(json, field.name()))
+                    {
+                        json_serializer<Json>::read_to(json_traits<Json>::get_existing_subkey(json, field.name()),
+                                                       field.value(), settings);
+                    }
+                    else
+                    {
+                        if (settings.missing_fields_mode == missing_fields::default_initialize)
+                            field.value() = {};
+                    }
+                });
+            });
+        }
     };
 
-    template <class Json>
-    struct json_walker<Json, std::string> : basic_json_walker
+    /// @brief Char strings with any allocator, e.g. plakpacs::pmr::string, go through std::string.
+    template <class Json, class Traits, class Alloc>
+    struct json_walker<Json, std::basic_string<char, Traits, Alloc>> : basic_json_walker
     {
-        static void read(const Json &json, std::string &to)
+        using string_type = std::basic_string<char, Traits, Alloc>;
+
+        static void read(const Json &json, string_type &to)
         {
-            to = json_traits<Json>::template get_typed_value<std::string>(json);
+            if constexpr (std::is_same_v<string_type, std::string>)
+            {
+                to = json_traits<Json>::template get_typed_value<std::string>(json);
+            }
+            else
+            {
+                auto value = json_traits<Json>::template get_typed_value<std::string>(json);
+                to.assign(value.data(), value.size());
+            }
         }
 
-        static void write(Json &json, const std::string &from)
+        static void write(Json &json, const string_type &from)
         {
-            json_traits<Json>::template write_typed_value<std::string>(json, from);
+            if constexpr (std::is_same_v<string_type, std::string>)
+                json_traits<Json>::template write_typed_value<std::string>(json, from);
+            else
+                json_traits<Json>::template write_typed_value<std::string>(json, std::string(from.data(), from.size()));
         }
     };
 
@@ -215,11 +291,32 @@ namespace bpjson
         {
         }
 
+        void reserve(std::size_t count)
+        {
+            if constexpr (detail::has_reserve<T>::value)
+                _container->reserve(std::size(*_container) + count);
+        }
+
         void append(const value_type &value)
         {
             _container->push_back(value);
         }
 
+        void append(value_type &&value)
+        {
+            _container->push_back(std::move(value));
+        }
+
+        /// @brief Reads the next element straight into the container where it can, instead of moving it in.
+        template <class Json>
+        void append_from(const Json &json)
+        {
+            if constexpr (detail::is_growable_array<T>::value)
+                json_serializer<Json>::read_to(json, _container->emplace_back());
+            else
+                append(json_serializer<Json>::template read<value_type>(json));
+        }
+
     private:
         T *_container;
     };
@@ -234,12 +331,29 @@ namespace bpjson
         {
         }
 
+        void reserve(std::size_t)
+        {
+        }
+
         void append(const value_type &value)
         {
             if (index < std::tuple_size_v<T>)
                 (*_container)[index++] = value;
         }
 
+        void append(value_type &&value)
+        {
+            if (index < std::tuple_size_v<T>)
+                (*_container)[index++] = std::move(value);
+        }
+
+        template <class Json>
+        void append_from(const Json &json)
+        {
+            if (index < std::tuple_size_v<T>)
+                (*_container)[index++] = json_serializer<Json>::template read<value_type>(json);
+        }
+
     private:
         T *_container;
         size_t index = 0;
@@ -254,14 +368,18 @@ namespace bpjson
 
         static void read(const Json &json, T &to)
         {
+            auto &&elements = json_traits<Json>::get_elements(json);
+
             container_appender appender{to};
-            for (auto &item : json)
-                appender.append(json_serializer<Json>::template read<value_type>(item));
+            appender.reserve(std::size(elements));
+
+            for (auto &&item : elements)
+                appender.append_from(item);
         }
 
         static void write(Json &json, const T &from)
         {
-            for (auto &item : from)
+            for (auto &&item : from)
                 json_traits<Json>::add_array_element(json, json_serializer<Json>::template write<value_type>(item));
         }
     };
@@ -274,7 +392,7 @@ namespace bpjson
         static void read(const Json &json, std::optional<T> &to)
         {
             if (!json_traits<Json>::is_null(json))
-                to = json_serializer<Json>::template read<T>(json);
+                json_serializer<Json>::read_to(json, to.emplace());
             else
                 to = std::nullopt;
         }
@@ -307,11 +425,11 @@ namespace bpjson
     {
         static void read(const Json &json, std::map<std::string, T> &to)
         {
-            for (auto &j : json_traits<Json>::get_keys(json))
+            for (auto &&j : json_traits<Json>::get_keys(json))
             {
-                auto key = json_traits<Json>::get_kp_key(j);
-                auto subkey = json_traits<Json>::get_existing_subkey(json, key);
-                json_serializer<Json>::read_to(json_traits<Json>::get_kp_value(j), to[key]);
+                // The value comes with the key, so there's nothing left to look up
+                std::string key(json_traits<Json>::get_kp_key(j));
+                json_serializer<Json>::read_to(json_traits<Json>::get_kp_value(j), to[std::move(key)]);
             }
         }
 
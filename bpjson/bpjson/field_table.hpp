@@ -0,0 +1,103 @@
+//
+//  field_table.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bpacs/bpacs.hpp>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace bpjson
+{
+    template <class T, std::size_t N = 0, typename = std::void_t<>>
+    struct field_count : std::integral_constant<std::size_t, N>
+    {
+    };
+
+    template <class T, std::size_t N>
+    struct field_count<T, N, std::void_t<typename bpacs::field_meta<T, N>::type>> : field_count<T, N + 1>
+    {
+    };
+
+    struct field_key
+    {
+        std::string_view name;
+        std::size_t index;
+    };
+
+    namespace detail
+    {
+        template <class T, std::size_t... I>
+        constexpr std::array<field_key, sizeof...(I)> make_field_keys(std::index_sequence<I...>)
+        {
+            std::array<field_key, sizeof...(I)> result{field_key{bpacs::field_meta<T, I>::name, I}...};
+
+            // Insertion sort; std::sort isn't constexpr before C++20
+            for (std::size_t i = 1; i < result.size(); i++)
+            {
+                for (std::size_t j = i; j > 0 && result[j].name < result[j - 1].name; j--)
+                {
+                    auto entry = result[j];
+                    result[j] = result[j - 1];
+                    result[j - 1] = entry;
+                }
+            }
+
+            return result;
+        }
+    } // namespace detail
+
+    /// @brief The bpacs field names of a reflected type, sorted at compile time, so that a JSON key can be matched
+    /// to its field with a binary search instead of a lookup per field.
+    template <class T>
+    struct field_table
+    {
+        static constexpr std::size_t size = field_count<T>::value;
+        static constexpr std::array<field_key, size> keys = detail::make_field_keys<T>(std::make_index_sequence<size>{});
+
+        /// @brief Returns the entry for a key, or nullptr if the type has no such field.
+        static constexpr const field_key *find(std::string_view name)
+        {
+            std::size_t first = 0;
+            std::size_t last = size;
+
+            while (first < last)
+            {
+                auto middle = first + (last - first) / 2;
+                auto &entry = keys[middle];
+
+                if (entry.name < name)
+                    first = middle + 1;
+                else if (name < entry.name)
+                    last = middle;
+                else
+                    return &entry;
+            }
+
+            return nullptr;
+        }
+    };
+
+    namespace detail
+    {
+        template <class T, class F, std::size_t... I>
+        bool visit_field(T &object, std::size_t index, F &&f, std::index_sequence<I...>)
+        {
+            return ((index == I ? (f(bpacs::get_field<T, I>(object)), true) : false) || ...);
+        }
+    } // namespace detail
+
+    /// @brief Calls f with the field at a runtime index, as bpacs::iterate_object would have.
+    /// @return false if the index is out of range
+    template <class T, class F>
+    bool visit_field(T &object, std::size_t index, F &&f)
+    {
+        return detail::visit_field(object, index, std::forward<F>(f), std::make_index_sequence<field_count<T>::value>{});
+    }
+} // namespace bpjson
@@ -7,6 +7,9 @@
 
 #pragma once
 #include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 #define BPJSON_NLOHMANN_BASIC_JSON_TPL_DECL                                                                            \
     template <template <typename, typename, typename...> class ObjectType,                                             \
@@ -39,6 +42,17 @@ namespace bpjson
             json = value;
         }
 
+        /// @brief Looks at a string without copying it out.
+        static std::string_view get_string_view(const json_type &json)
+        {
+            if (!json.is_string())
+                throw std::runtime_error(
+                    std::string("bpjson::json_traits<nlohmann::basic_json>: type must be string, but is ") +
+                    json.type_name());
+
+            return *json.template get_ptr<const typename json_type::string_t *>();
+        }
+
         ////////////////////////////////////////////////////////////////////
 
         template <class S>
@@ -80,6 +94,11 @@ namespace bpjson
             json.push_back(element);
         }
 
+        static void add_array_element(json_type &json, json_type &&element)
+        {
+            json.push_back(std::move(element));
+        }
+
         ////////////////////////////////////////////////////////////////////
 
         static bool is_null(const json_type &json)
@@ -87,6 +106,11 @@ namespace bpjson
             return json.is_null();
         }
 
+        static bool is_object(const json_type &json)
+        {
+            return json.is_object();
+        }
+
         static void make_null(json_type &json)
         {
             json = {};
@@ -0,0 +1,352 @@
+//
+//  sax_handler.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bpjson.hpp"
+#include "nlohmann_traits.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bpjson
+{
+    namespace detail
+    {
+        /// @brief The part of a SAX consumer that doesn't depend on what it produces: the stack of open objects and arrays,
+        /// skipping unknown values, building a small DOM for values without a direct path, and turning exceptions into an
+        /// error message with the path they happened at. Used by sax_reader and bptranscode::sax_transcoder.
+        ///
+        /// Output holds whatever the consumer writes to, and its frame_state whatever it keeps per open object or array.
+        /// Each value is handed to the value_ops of the slot it goes in; the consumer picks the slots through frame_ops.
+        template <class Json, class Output>
+        class sax_handler : public Output
+        {
+        public:
+            using string_t = typename Json::string_t;
+            using number_integer_t = typename Json::number_integer_t;
+            using number_unsigned_t = typename Json::number_unsigned_t;
+            using number_float_t = typename Json::number_float_t;
+            using binary_t = typename Json::binary_t;
+
+            struct frame;
+
+            struct value_ops
+            {
+                void (*null)(sax_handler &, void *);
+                void (*boolean)(sax_handler &, void *, bool);
+                void (*number_integer)(sax_handler &, void *, number_integer_t);
+                void (*number_unsigned)(sax_handler &, void *, number_unsigned_t);
+                void (*number_float)(sax_handler &, void *, number_float_t);
+                void (*string)(sax_handler &, void *, string_t &);
+                void (*start_object)(sax_handler &, void *);
+                void (*start_array)(sax_handler &, void *);
+            };
+
+            /// @brief Where the next value goes. A slot without ops skips the value; outputs that only append leave the
+            /// target null.
+            struct slot
+            {
+                void *target = nullptr;
+                const value_ops *ops = nullptr;
+            };
+
+            struct frame_ops
+            {
+                bool is_array;
+                slot (*key)(sax_handler &, frame &, string_t &);
+                slot (*element)(sax_handler &, frame &);
+                void (*end)(sax_handler &, frame &);
+            };
+
+            struct frame : Output::frame_state
+            {
+                void *target = nullptr;
+                const frame_ops *ops = nullptr;
+
+                // Objects: the slot picked by the last key, and the key itself for error messages
+                slot pending;
+                std::string_view key;
+
+                // Arrays: the number of elements so far
+                std::size_t count = 0;
+            };
+
+            using finish_function = void (*)(sax_handler &, void *, Json &&);
+
+            explicit sax_handler(const serialization_settings &settings) : settings(settings)
+            {
+            }
+
+            void reset(slot target)
+            {
+                Output::reset();
+                root = target;
+                frames.clear();
+                dom.stack.clear();
+                skip_depth = 0;
+                error.clear();
+            }
+
+            bool null()
+            {
+                return scalar(nullptr, [&](const slot &s) { s.ops->null(*this, s.target); });
+            }
+
+            bool boolean(bool value)
+            {
+                return scalar(value, [&](const slot &s) { s.ops->boolean(*this, s.target, value); });
+            }
+
+            bool number_integer(number_integer_t value)
+            {
+                return scalar(value, [&](const slot &s) { s.ops->number_integer(*this, s.target, value); });
+            }
+
+            bool number_unsigned(number_unsigned_t value)
+            {
+                return scalar(value, [&](const slot &s) { s.ops->number_unsigned(*this, s.target, value); });
+            }
+
+            bool number_float(number_float_t value, const string_t &)
+            {
+                return scalar(value, [&](const slot &s) { s.ops->number_float(*this, s.target, value); });
+            }
+
+            bool string(string_t &value)
+            {
+                // Only one of the two branches runs, so the value is moved at most once
+                return scalar(std::move(value), [&](const slot &s) { s.ops->string(*this, s.target, value); });
+            }
+
+            bool binary(binary_t &)
+            {
+                error = "binary values aren't supported";
+                return false;
+            }
+
+            bool start_object(std::size_t)
+            {
+                return start(true, [&](const slot &s) { s.ops->start_object(*this, s.target); });
+            }
+
+            bool start_array(std::size_t)
+            {
+                return start(false, [&](const slot &s) { s.ops->start_array(*this, s.target); });
+            }
+
+            bool key(string_t &name)
+            {
+                return guard([&] {
+                    if (!dom.stack.empty())
+                        dom.key = std::move(name);
+                    else if (skip_depth == 0)
+                        frames.back().pending = frames.back().ops->key(*this, frames.back(), name);
+                });
+            }
+
+            bool end_object()
+            {
+                return end();
+            }
+
+            bool end_array()
+            {
+                return end();
+            }
+
+            bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &e)
+            {
+                fail(e.what());
+                return false;
+            }
+
+            frame &push_frame(void *target, const frame_ops *ops)
+            {
+                auto &result = frames.emplace_back();
+                result.target = target;
+                result.ops = ops;
+                return result;
+            }
+
+            /// @brief Collects the events of the value that just started into a DOM, handed to finish once it ends.
+            void begin_dom(Json value, void *target, finish_function finish)
+            {
+                dom.root = std::move(value);
+                dom.stack.assign(1, &dom.root);
+                dom.target = target;
+                dom.finish = finish;
+            }
+
+            serialization_settings settings;
+            std::vector<frame> frames;
+            std::string error;
+
+        private:
+            /// @brief Collects the events of a value that goes through the DOM path.
+            struct dom_builder
+            {
+                Json root;
+                std::vector<Json *> stack;
+                string_t key;
+                void *target = nullptr;
+                finish_function finish = nullptr;
+
+                Json *add(Json &&value)
+                {
+                    auto &top = *stack.back();
+
+                    if (top.is_array())
+                    {
+                        top.push_back(std::move(value));
+                        return &top.back();
+                    }
+
+                    auto &element = top[key];
+                    element = std::move(value);
+                    return &element;
+                }
+            };
+
+            template <class F>
+            bool guard(F &&f)
+            {
+                try
+                {
+                    f();
+                    return true;
+                }
+                catch (const std::exception &e)
+                {
+                    fail(e.what());
+                }
+                catch (...)
+                {
+                    fail("caught unknown exception");
+                }
+
+                return false;
+            }
+
+            void fail(const char *what)
+            {
+                auto where = path();
+                error = where.empty() ? what : "at '" + where + "': " + what;
+            }
+
+            std::string path() const
+            {
+                std::string result;
+
+                for (auto &f : frames)
+                {
+                    if (f.ops->is_array)
+                    {
+                        if (f.count > 0)
+                            result += "[" + std::to_string(f.count - 1) + "]";
+                    }
+                    else if (!f.key.empty())
+                    {
+                        if (!result.empty())
+                            result += '.';
+
+                        result += f.key;
+                    }
+                }
+
+                return result;
+            }
+
+            slot next_slot()
+            {
+                if (frames.empty())
+                    return std::exchange(root, slot{});
+
+                auto &top = frames.back();
+
+                if (!top.ops->is_array)
+                    return top.pending;
+
+                auto result = top.ops->element(*this, top);
+                top.count++;
+                return result;
+            }
+
+            template <class Value, class Apply>
+            bool scalar(Value &&value, Apply &&apply)
+            {
+                return guard([&] {
+                    if (!dom.stack.empty())
+                    {
+                        dom.add(Json(std::forward<Value>(value)));
+                    }
+                    else if (skip_depth == 0)
+                    {
+                        auto target = next_slot();
+
+                        if (target.ops)
+                            apply(target);
+                    }
+                });
+            }
+
+            template <class Apply>
+            bool start(bool object, Apply &&apply)
+            {
+                return guard([&] {
+                    if (!dom.stack.empty())
+                    {
+                        dom.stack.push_back(dom.add(object ? Json::object() : Json::array()));
+                    }
+                    else if (skip_depth > 0)
+                    {
+                        skip_depth++;
+                    }
+                    else
+                    {
+                        auto target = next_slot();
+
+                        if (target.ops)
+                            apply(target);
+                        else
+                            skip_depth = 1;
+                    }
+                });
+            }
+
+            bool end()
+            {
+                return guard([&] {
+                    if (!dom.stack.empty())
+                    {
+                        dom.stack.pop_back();
+
+                        if (dom.stack.empty())
+                            dom.finish(*this, dom.target, std::move(dom.root));
+                    }
+                    else if (skip_depth > 0)
+                    {
+                        skip_depth--;
+                    }
+                    else
+                    {
+                        // Errors from end() are about the object itself, not its last field
+                        frames.back().key = {};
+                        frames.back().ops->end(*this, frames.back());
+                        frames.pop_back();
+                    }
+                });
+            }
+
+            dom_builder dom;
+            slot root;
+            std::size_t skip_depth = 0;
+        };
+    } // namespace detail
+} // namespace bpjson
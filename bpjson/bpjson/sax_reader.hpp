@@ -0,0 +1,323 @@
+//
+//  sax_reader.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bpjson.hpp"
+#include "field_table.hpp"
+#include "nlohmann_traits.hpp"
+#include "sax_handler.hpp"
+#include "value_kind.hpp"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bpjson
+{
+    /// @brief Reads reflected types straight from nlohmann's SAX events, without building a DOM first. Keys are matched
+    /// to fields through field_table, and strings are moved out of the parser. The result and the missing field handling
+    /// are the same as with json_serializer::read. Types this reader doesn't know (and Json members) are built as a small
+    /// DOM of just their own value and handed to json_serializer, so custom json_walker specializations keep working.
+    ///
+    /// A reader keeps its stacks between calls, so reusing one for many documents doesn't allocate for them again.
+    /// Input is anything Json::sax_parse takes: a string, a std::istream, a FILE*, a pair of iterators...
+    template <class Json>
+    class sax_reader
+    {
+    public:
+        explicit sax_reader(const serialization_settings &settings = {}) : _handler(settings)
+        {
+        }
+
+        template <class T, class Input>
+        T read(Input &&input)
+        {
+            T value{};
+            read_to(std::forward<Input>(input), value);
+            return value;
+        }
+
+        template <class T, class Input>
+        void read_to(Input &&input, T &to)
+        {
+            _handler.reset(slot_of(to));
+
+            if (!Json::sax_parse(std::forward<Input>(input), &_handler))
+                throw std::runtime_error("bpjson::sax_reader.read: " + _handler.error);
+        }
+
+    private:
+        using string_t = typename Json::string_t;
+        using number_integer_t = typename Json::number_integer_t;
+        using number_unsigned_t = typename Json::number_unsigned_t;
+        using number_float_t = typename Json::number_float_t;
+        using value_kind = detail::value_kind;
+
+        /// @brief What the reader keeps on top of the shared SAX state: which fields of the objects being read were seen.
+        struct reader_state
+        {
+            struct frame_state
+            {
+                // Reflected objects: where their seen flags start in seen
+                std::size_t seen = 0;
+            };
+
+            std::vector<bool> seen;
+
+            void reset()
+            {
+                seen.clear();
+            }
+        };
+
+        using handler = detail::sax_handler<Json, reader_state>;
+        using value_ops = typename handler::value_ops;
+        using slot = typename handler::slot;
+        using frame_ops = typename handler::frame_ops;
+        using frame = typename handler::frame;
+
+        template <class T>
+        static slot slot_of(T &to)
+        {
+            return {&to, &sink<T>::ops};
+        }
+
+        static void push_object(handler &h, void *target, const frame_ops *ops, std::size_t fields)
+        {
+            h.push_frame(target, ops).seen = h.seen.size();
+            h.seen.resize(h.seen.size() + fields, false);
+        }
+
+        template <class T>
+        struct sink
+        {
+            static constexpr value_kind kind = detail::value_kind_of<Json, T>();
+
+            static void null(handler &h, void *target)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                // Like the DOM path, null leaves containers untouched
+                if constexpr (kind == value_kind::optional)
+                    to = std::nullopt;
+                else if constexpr (kind == value_kind::array || kind == value_kind::map)
+                    return;
+                else if constexpr (kind == value_kind::json || kind == value_kind::fallback)
+                    finish(h, target, Json(nullptr));
+                else
+                    type_error("null");
+            }
+
+            static void boolean(handler &h, void *target, bool value)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                if constexpr (kind == value_kind::boolean || kind == value_kind::number)
+                    to = static_cast<T>(value);
+                else if constexpr (kind == value_kind::optional)
+                    sink<typename T::value_type>::boolean(h, &to.emplace(), value);
+                else if constexpr (kind == value_kind::json || kind == value_kind::fallback)
+                    finish(h, target, Json(value));
+                else
+                    type_error("boolean");
+            }
+
+            template <class V>
+            static void number(handler &h, void *target, V value)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                if constexpr (kind == value_kind::number)
+                    to = static_cast<T>(value);
+                else if constexpr (kind == value_kind::optional)
+                    sink<typename T::value_type>::template number<V>(h, &to.emplace(), value);
+                else if constexpr (kind == value_kind::json || kind == value_kind::fallback)
+                    finish(h, target, Json(value));
+                else
+                    type_error("number");
+            }
+
+            static void string(handler &h, void *target, string_t &value)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                if constexpr (kind == value_kind::string)
+                {
+                    if constexpr (std::is_assignable_v<T &, string_t &&>)
+                        to = std::move(value);
+                    else
+                        to.assign(value.data(), value.size());
+                }
+                else if constexpr (kind == value_kind::optional)
+                    sink<typename T::value_type>::string(h, &to.emplace(), value);
+                else if constexpr (kind == value_kind::json || kind == value_kind::fallback)
+                    finish(h, target, Json(std::move(value)));
+                else
+                    type_error("string");
+            }
+
+            static void start_object(handler &h, void *target)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                if constexpr (kind == value_kind::object)
+                    push_object(h, target, &object_frame<T>::ops, field_table<T>::size);
+                else if constexpr (kind == value_kind::map)
+                    h.push_frame(target, &map_frame<T>::ops);
+                else if constexpr (kind == value_kind::optional)
+                    sink<typename T::value_type>::start_object(h, &to.emplace());
+                else if constexpr (kind == value_kind::json || kind == value_kind::fallback)
+                    h.begin_dom(Json::object(), target, &finish);
+                else
+                    type_error("object");
+            }
+
+            static void start_array(handler &h, void *target)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                if constexpr (kind == value_kind::array)
+                    h.push_frame(target, &array_frame<T>::ops);
+                else if constexpr (kind == value_kind::optional)
+                    sink<typename T::value_type>::start_array(h, &to.emplace());
+                else if constexpr (kind == value_kind::json || kind == value_kind::fallback)
+                    h.begin_dom(Json::array(), target, &finish);
+                else
+                    type_error("array");
+            }
+
+            static void finish(handler &h, void *target, Json &&json)
+            {
+                auto &to = *static_cast<T *>(target);
+
+                if constexpr (kind == value_kind::json)
+                    to = std::move(json);
+                else if constexpr (kind == value_kind::fallback)
+                    json_serializer<Json>::read_to(json, to, h.settings);
+            }
+
+            [[noreturn]] static void type_error(const char *actual)
+            {
+                const char *expected = "number";
+
+                if constexpr (kind == value_kind::object || kind == value_kind::map)
+                    expected = "object";
+                else if constexpr (kind == value_kind::array)
+                    expected = "array";
+                else if constexpr (kind == value_kind::string)
+                    expected = "string";
+                else if constexpr (kind == value_kind::boolean)
+                    expected = "boolean";
+
+                throw std::runtime_error(std::string("type must be ") + expected + ", but is " + actual);
+            }
+
+            static constexpr value_ops ops{&null,
+                                           &boolean,
+                                           &number<number_integer_t>,
+                                           &number<number_unsigned_t>,
+                                           &number<number_float_t>,
+                                           &string,
+                                           &start_object,
+                                           &start_array};
+        };
+
+        template <class T>
+        struct object_frame
+        {
+            static slot key(handler &h, frame &f, string_t &name)
+            {
+                auto entry = field_table<T>::find(name);
+
+                if (!entry)
+                {
+                    f.key = {};
+                    return {};
+                }
+
+                auto seen = f.seen + entry->index;
+                slot result;
+
+                visit_field(*static_cast<T *>(f.target), entry->index, [&](auto field) {
+                    // The last of several equal keys wins, like in the DOM
+                    if (h.seen[seen])
+                        field.value() = {};
+
+                    result = slot_of(field.value());
+                });
+
+                h.seen[seen] = true;
+                f.key = entry->name;
+                return result;
+            }
+
+            static void end(handler &h, frame &f)
+            {
+                bpacs::iterate_object(*static_cast<T *>(f.target), [&h, &f](auto field) {
+                    if (h.seen[f.seen + field.index()])
+                        return;
+
+                    if (h.settings.missing_fields_mode == missing_fields::throw_exception &&
+                        !json_walker<Json, T>::force_optional && !json_fields_optional<T>::value)
+                        throw std::runtime_error(std::string("field '") + field.name() + "' is missing");
+
+                    if (h.settings.missing_fields_mode == missing_fields::default_initialize)
+                        field.value() = {};
+                });
+
+                h.seen.resize(f.seen);
+            }
+
+            static constexpr frame_ops ops{false, &key, nullptr, &end};
+        };
+
+        template <class T>
+        struct map_frame
+        {
+            static slot key(handler &, frame &f, string_t &name)
+            {
+                auto [it, inserted] = static_cast<T *>(f.target)->try_emplace(std::move(name));
+
+                if (!inserted)
+                    it->second = {};
+
+                f.key = it->first;
+                return slot_of(it->second);
+            }
+
+            static void end(handler &, frame &)
+            {
+            }
+
+            static constexpr frame_ops ops{false, &key, nullptr, &end};
+        };
+
+        template <class T>
+        struct array_frame
+        {
+            static slot element(handler &, frame &f)
+            {
+                auto &to = *static_cast<T *>(f.target);
+
+                // Fixed arrays drop whatever doesn't fit, like container_appender does
+                if constexpr (detail::is_fixed_array<T>::value)
+                    return f.count < std::tuple_size<T>::value ? slot_of(to[f.count]) : slot{};
+                else
+                    return slot_of(to.emplace_back());
+            }
+
+            static void end(handler &, frame &)
+            {
+            }
+
+            static constexpr frame_ops ops{true, nullptr, &element, &end};
+        };
+
+        handler _handler;
+    };
+} // namespace bpjson
@@ -0,0 +1,172 @@
+//
+//  simdjson_traits.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bpjson.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <simdjson.h>
+
+namespace bpjson
+{
+    /// @brief Read-only traits over simdjson's DOM, for reading the same reflected types several times faster than
+    /// through nlohmann. Elements point into their parser, which has to outlive the read:
+    ///
+    ///     simdjson::dom::parser parser;
+    ///     auto record = bpjson::json_serializer<simdjson::dom::element>::read<Record>(parser.parse(text));
+    ///
+    /// Values convert the way nlohmann's get<T>() does: numbers into any arithmetic type, booleans into numbers too.
+    template <>
+    struct json_traits<simdjson::dom::element> : basic_json_traits<simdjson::dom::element>
+    {
+        using json_type = simdjson::dom::element;
+
+        ////////////////////////////////////////////////////////////////////
+
+        template <class T>
+        static T get_typed_value(const json_type &json)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                if (!json.is_bool())
+                    type_error("boolean", json);
+
+                return json.get_bool().value_unsafe();
+            }
+            else if constexpr (std::is_arithmetic_v<T>)
+            {
+                switch (json.type())
+                {
+                case simdjson::dom::element_type::INT64:
+                    return static_cast<T>(json.get_int64().value_unsafe());
+                case simdjson::dom::element_type::UINT64:
+                    return static_cast<T>(json.get_uint64().value_unsafe());
+                case simdjson::dom::element_type::DOUBLE:
+                    return static_cast<T>(json.get_double().value_unsafe());
+                case simdjson::dom::element_type::BOOL:
+                    return static_cast<T>(json.get_bool().value_unsafe());
+                default:
+                    type_error("number", json);
+                }
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                return static_cast<T>(get_typed_value<std::underlying_type_t<T>>(json));
+            }
+            else
+            {
+                static_assert(std::is_constructible_v<T, std::string_view>,
+                              "bpjson::json_traits<simdjson::dom::element>: unsupported value type");
+
+                if (!json.is_string())
+                    type_error("string", json);
+
+                return T(json.get_string().value_unsafe());
+            }
+        }
+
+        static std::string_view get_string_view(const json_type &json)
+        {
+            if (!json.is_string())
+                type_error("string", json);
+
+            return json.get_string().value_unsafe();
+        }
+
+        ////////////////////////////////////////////////////////////////////
+
+        static bool subkey_exists(const json_type &json, std::string_view key)
+        {
+            return !json.at_key(key).error();
+        }
+
+        static json_type get_existing_subkey(const json_type &json, std::string_view key)
+        {
+            json_type value;
+
+            if (auto error = json.at_key(key).get(value))
+                throw std::runtime_error("bpjson::json_traits<simdjson::dom::element>: key '" + std::string(key) +
+                                         "' - " + simdjson::error_message(error));
+
+            return value;
+        }
+
+        ////////////////////////////////////////////////////////////////////
+
+        static bool is_null(const json_type &json)
+        {
+            return json.is_null();
+        }
+
+        static bool is_object(const json_type &json)
+        {
+            return json.is_object();
+        }
+
+        static void copy(json_type &to, const json_type &from)
+        {
+            to = from;
+        }
+
+        ////////////////////////////////////////////////////////////////////
+
+        static simdjson::dom::array get_elements(const json_type &json)
+        {
+            if (!json.is_array())
+                type_error("array", json);
+
+            return json.get_array().value_unsafe();
+        }
+
+        static simdjson::dom::object get_keys(const json_type &json)
+        {
+            if (!json.is_object())
+                type_error("object", json);
+
+            return json.get_object().value_unsafe();
+        }
+
+        static std::string_view get_kp_key(const simdjson::dom::key_value_pair &kv)
+        {
+            return kv.key;
+        }
+
+        static const json_type &get_kp_value(const simdjson::dom::key_value_pair &kv)
+        {
+            return kv.value;
+        }
+
+    private:
+        [[noreturn]] static void type_error(const char *expected, const json_type &json)
+        {
+            throw std::runtime_error(std::string("bpjson::json_traits<simdjson::dom::element>: type must be ") +
+                                     expected + ", but is " + type_name(json));
+        }
+
+        static const char *type_name(const json_type &json)
+        {
+            switch (json.type())
+            {
+            case simdjson::dom::element_type::ARRAY:
+                return "array";
+            case simdjson::dom::element_type::OBJECT:
+                return "object";
+            case simdjson::dom::element_type::STRING:
+                return "string";
+            case simdjson::dom::element_type::BOOL:
+                return "boolean";
+            case simdjson::dom::element_type::NULL_VALUE:
+                return "null";
+            default:
+                return "number";
+            }
+        }
+    };
+} // namespace bpjson
@@ -0,0 +1,368 @@
+//
+//  text_writer.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bpjson.hpp"
+#include "field_table.hpp"
+#include "value_kind.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace bpjson
+{
+    namespace detail
+    {
+        // Field names are C++ identifiers, so they never need escaping
+        template <std::size_t N>
+        constexpr std::array<char, N + 3> make_key_literal(std::string_view name)
+        {
+            std::array<char, N + 3> result{};
+            result[0] = '"';
+
+            for (std::size_t i = 0; i < N; i++)
+                result[i + 1] = name[i];
+
+            result[N + 1] = '"';
+            result[N + 2] = ':';
+            return result;
+        }
+
+        /// @brief "name": for a reflected field, ready to be copied out in one go.
+        template <class T, std::size_t I>
+        inline constexpr auto key_literal = make_key_literal<std::char_traits<char>::length(bpacs::field_meta<T, I>::name)>(
+            bpacs::field_meta<T, I>::name);
+
+        /// @brief Appends straight to a string.
+        class string_output
+        {
+        public:
+            explicit string_output(std::string &out) : _out(&out)
+            {
+            }
+
+            void put(char c)
+            {
+                _out->push_back(c);
+            }
+
+            void append(const char *data, std::size_t size)
+            {
+                _out->append(data, size);
+            }
+
+        private:
+            std::string *_out;
+        };
+
+        /// @brief Collects output in a fixed buffer and hands it to the sink whenever the buffer fills up.
+        template <class Sink>
+        class buffered_output
+        {
+        public:
+            static constexpr std::size_t capacity = 4096;
+
+            explicit buffered_output(Sink &sink) : _sink(&sink)
+            {
+            }
+
+            void put(char c)
+            {
+                if (_size == capacity)
+                    flush();
+
+                _buffer[_size++] = c;
+            }
+
+            void append(const char *data, std::size_t size)
+            {
+                if (_size + size > capacity)
+                {
+                    flush();
+
+                    // Too big to be worth copying
+                    if (size > capacity)
+                    {
+                        (*_sink)(data, size);
+                        return;
+                    }
+                }
+
+                std::memcpy(_buffer.data() + _size, data, size);
+                _size += size;
+            }
+
+            void flush()
+            {
+                if (_size > 0)
+                    (*_sink)(_buffer.data(), _size);
+
+                _size = 0;
+            }
+
+        private:
+            Sink *_sink;
+            std::array<char, capacity> _buffer;
+            std::size_t _size = 0;
+        };
+    } // namespace detail
+
+    /// @brief Writes reflected types out as JSON text directly, without building a Json tree first. Keys come from
+    /// precomputed literals and numbers are formatted with std::to_chars. The output is what json_serializer::write
+    /// followed by dump() gives, except that keys keep their declaration order, floats are printed in their own
+    /// precision, and strings are copied as they are, without UTF-8 validation.
+    /// Json members and types without a direct path (e.g. with their own json_walker) are written through
+    /// json_serializer and dump().
+    template <class Json>
+    class text_writer
+    {
+    public:
+        template <class T>
+        static std::string write(const T &value, const serialization_settings &settings = {})
+        {
+            std::string text;
+            write_to(text, value, settings);
+            return text;
+        }
+
+        /// @brief Appends the text to a string.
+        template <class T>
+        static void write_to(std::string &out, const T &value, const serialization_settings &settings = {})
+        {
+            detail::string_output output(out);
+            write_value(output, value, settings);
+        }
+
+        template <class T>
+        static void write_to(std::ostream &out, const T &value, const serialization_settings &settings = {})
+        {
+            write_to_sink([&out](const char *data, std::size_t size) { out.write(data, (std::streamsize)size); }, value,
+                          settings);
+        }
+
+        /// @brief Writes the text in chunks of up to a few KB to sink(const char* data, std::size_t size),
+        /// e.g. straight into a socket's send buffer.
+        template <class Sink, class T>
+        static void write_to_sink(Sink &&sink, const T &value, const serialization_settings &settings = {})
+        {
+            detail::buffered_output<std::remove_reference_t<Sink>> output(sink);
+            write_value(output, value, settings);
+            output.flush();
+        }
+
+        /// @brief Writes to any output with put(char c) and append(const char* data, std::size_t size), such as
+        /// detail::string_output.
+        template <class Output, class T>
+        static void write_value(Output &out, const T &value, const serialization_settings &settings)
+        {
+            using kind = detail::value_kind;
+            constexpr auto type = detail::value_kind_of<Json, T>();
+
+            if constexpr (type == kind::object)
+            {
+                write_object(out, value, settings, std::make_index_sequence<field_count<T>::value>{});
+            }
+            else if constexpr (type == kind::optional)
+            {
+                if (value.has_value())
+                    write_value(out, *value, settings);
+                else
+                    out.append("null", 4);
+            }
+            else if constexpr (type == kind::boolean)
+            {
+                if (value)
+                    out.append("true", 4);
+                else
+                    out.append("false", 5);
+            }
+            else if constexpr (type == kind::number)
+            {
+                write_number(out, value);
+            }
+            else if constexpr (type == kind::string)
+            {
+                write_string(out, value);
+            }
+            else if constexpr (type == kind::map)
+            {
+                out.put('{');
+
+                bool first = true;
+                for (auto &pair : value)
+                {
+                    if (!first)
+                        out.put(',');
+
+                    first = false;
+                    write_string(out, pair.first);
+                    out.put(':');
+                    write_value(out, pair.second, settings);
+                }
+
+                out.put('}');
+            }
+            else if constexpr (type == kind::array || (type == kind::fallback && detail::is_iterable<T>::value))
+            {
+                // Fallback containers are the ones that can't be read back in place, like vector<bool>
+                out.put('[');
+
+                bool first = true;
+                for (auto &&item : value)
+                {
+                    if (!first)
+                        out.put(',');
+
+                    first = false;
+                    write_value(out, item, settings);
+                }
+
+                out.put(']');
+            }
+            else if constexpr (type == kind::json)
+            {
+                auto text = value.dump();
+                out.append(text.data(), text.size());
+            }
+            else
+            {
+                auto text = json_serializer<Json>::write(value, settings).dump();
+                out.append(text.data(), text.size());
+            }
+        }
+
+        template <class Output>
+        static void write_string(Output &out, std::string_view value)
+        {
+            static constexpr char hex[] = "0123456789abcdef";
+
+            out.put('"');
+
+            // Copy runs of plain characters in one go and escape whatever is in between
+            std::size_t run = 0;
+            for (std::size_t i = 0; i < value.size(); i++)
+            {
+                auto c = (unsigned char)value[i];
+
+                if (c >= 0x20 && c != '"' && c != '\\')
+                    continue;
+
+                out.append(value.data() + run, i - run);
+                run = i + 1;
+
+                switch (c)
+                {
+                case '"':
+                    out.append("\\\"", 2);
+                    break;
+                case '\\':
+                    out.append("\\\\", 2);
+                    break;
+                case '\b':
+                    out.append("\\b", 2);
+                    break;
+                case '\f':
+                    out.append("\\f", 2);
+                    break;
+                case '\n':
+                    out.append("\\n", 2);
+                    break;
+                case '\r':
+                    out.append("\\r", 2);
+                    break;
+                case '\t':
+                    out.append("\\t", 2);
+                    break;
+                default: {
+                    char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    out.append(escaped, sizeof(escaped));
+                    break;
+                }
+                }
+            }
+
+            out.append(value.data() + run, value.size() - run);
+            out.put('"');
+        }
+
+    private:
+        template <class Output, class T, std::size_t... I>
+        static void write_object(Output &out, const T &object, const serialization_settings &settings,
+                                 std::index_sequence<I...>)
+        {
+            out.put('{');
+            (write_field<I>(out, object, settings), ...);
+            out.put('}');
+        }
+
+        template <std::size_t I, class Output, class T>
+        static void write_field(Output &out, const T &object, const serialization_settings &settings)
+        {
+            auto field = bpacs::get_const_field<T, I>(object);
+
+            try
+            {
+                if constexpr (I > 0)
+                    out.put(',');
+
+                auto &key = detail::key_literal<T, I>;
+                out.append(key.data(), key.size());
+                write_value(out, field.value(), settings);
+            }
+            catch (const std::exception &e)
+            {
+                throw std::runtime_error(std::string("bpjson::text_writer.write_object: field '") + field.name() +
+                                         "' caught exception - " + e.what());
+            }
+        }
+
+        template <class Output, class T>
+        static void write_number(Output &out, T value)
+        {
+            char buffer[64];
+            char *end = buffer;
+
+            if constexpr (std::is_integral_v<T>)
+            {
+                end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+            }
+            else
+            {
+                // nlohmann writes non-finite numbers as null too
+                if (!std::isfinite(value))
+                {
+                    out.append("null", 4);
+                    return;
+                }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+                end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+#else
+                end = buffer + std::snprintf(buffer, sizeof(buffer), "%.*g", std::is_same_v<T, float> ? 9 : 17,
+                                             (double)value);
+#endif
+
+                // Keep integral floats floats when they're read back
+                if (std::find_if(buffer, end, [](char c) { return c == '.' || c == 'e'; }) == end)
+                {
+                    *end++ = '.';
+                    *end++ = '0';
+                }
+            }
+
+            out.append(buffer, (std::size_t)(end - buffer));
+        }
+    };
+} // namespace bpjson
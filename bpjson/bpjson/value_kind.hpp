@@ -0,0 +1,136 @@
+//
+//  value_kind.hpp
+//  bpjson
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bpacs/bpacs.hpp>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bpjson
+{
+    namespace detail
+    {
+        /// @brief How the readers and writers that work without a DOM treat a type. Anything they have no direct path for is
+        /// a fallback and goes through json_serializer.
+        enum class value_kind
+        {
+            object,
+            map,
+            array,
+            optional,
+            string,
+            boolean,
+            number,
+            json,
+            fallback
+        };
+
+        template <class T>
+        struct is_std_optional : std::false_type
+        {
+        };
+
+        template <class T>
+        struct is_std_optional<std::optional<T>> : std::true_type
+        {
+        };
+
+        template <class T>
+        struct is_string_map : std::false_type
+        {
+        };
+
+        template <class T, class C, class A>
+        struct is_string_map<std::map<std::string, T, C, A>> : std::true_type
+        {
+        };
+
+        template <class T, typename = std::void_t<>>
+        struct is_char_string : std::false_type
+        {
+        };
+
+        // Anything deriving from a char string, so sp_string is read as a string too
+        template <class T>
+        struct is_char_string<T, std::void_t<typename T::traits_type, typename T::allocator_type>>
+            : std::is_base_of<std::basic_string<char, typename T::traits_type, typename T::allocator_type>, T>
+        {
+        };
+
+        template <class T, typename = std::void_t<>>
+        struct is_fixed_array : std::false_type
+        {
+        };
+
+        template <class T>
+        struct is_fixed_array<T, std::void_t<decltype(std::tuple_size<T>::value), decltype(std::declval<T &>()[0])>>
+            : std::true_type
+        {
+        };
+
+        // vector<bool> hands out proxies instead of references, so it's left to the DOM path
+        template <class T, typename = std::void_t<>>
+        struct is_growable_array : std::false_type
+        {
+        };
+
+        template <class T>
+        struct is_growable_array<T, std::void_t<decltype(std::declval<T &>().emplace_back())>>
+            : std::is_same<decltype(std::declval<T &>().emplace_back()), typename T::value_type &>
+        {
+        };
+
+        template <class T, typename = std::void_t<>>
+        struct has_reserve : std::false_type
+        {
+        };
+
+        template <class T>
+        struct has_reserve<T, std::void_t<decltype(std::declval<T &>().reserve(std::size_t()))>> : std::true_type
+        {
+        };
+
+        template <class T, typename = std::void_t<>>
+        struct is_iterable : std::false_type
+        {
+        };
+
+        template <class T>
+        struct is_iterable<T, std::void_t<decltype(std::begin(std::declval<const T &>())), decltype(std::end(std::declval<const T &>()))>>
+            : std::true_type
+        {
+        };
+
+        template <class Json, class T>
+        constexpr value_kind value_kind_of()
+        {
+            if constexpr (std::is_same_v<T, Json>)
+                return value_kind::json;
+            else if constexpr (bpacs::has_bp_reflection<T>::value)
+                return value_kind::object;
+            else if constexpr (is_std_optional<T>::value)
+                return value_kind::optional;
+            else if constexpr (std::is_same_v<T, bool>)
+                return value_kind::boolean;
+            else if constexpr (std::is_arithmetic_v<T>)
+                return value_kind::number;
+            else if constexpr (is_char_string<T>::value)
+                return value_kind::string;
+            else if constexpr (is_string_map<T>::value)
+                return value_kind::map;
+            else if constexpr (is_fixed_array<T>::value || is_growable_array<T>::value)
+                return value_kind::array;
+            else
+                return value_kind::fallback;
+        }
+    } // namespace detail
+} // namespace bpjson
@@ -0,0 +1,8 @@
+//
+//  bptranscode.cpp
+//  bptranscode
+//
+//  Created on 18.10.2026.
+//
+
+#include "bptranscode.hpp"
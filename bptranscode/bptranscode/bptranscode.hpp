@@ -0,0 +1,505 @@
+//
+//  bptranscode.hpp
+//  bptranscode
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bpacs/bpacs.hpp>
+#include <bpjson/bpjson.hpp>
+#include <bpjson/field_table.hpp>
+#include <bpjson/text_writer.hpp>
+#include <bpjson/value_kind.hpp>
+#include <plakpacs/plakpacs.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bptranscode
+{
+    namespace detail
+    {
+        /// @brief How a type is laid out in plakpacs, as far as the transcoder is concerned. Anything it has no
+        /// direct path for is a fallback and goes through a C++ value of its own.
+        enum class binary_kind
+        {
+            object,
+            optional,
+            constrained,
+            size_prefixed_string,
+            size_prefixed_array,
+            string,
+            fixed_array,
+            array,
+            scalar,
+            fallback
+        };
+
+        template <class T>
+        struct constrained_type
+        {
+        };
+
+        template <class T, class... Cs>
+        struct constrained_type<plakpacs::constrained<T, Cs...>>
+        {
+            using type = T;
+        };
+
+        template <class T, typename = std::void_t<>>
+        struct is_constrained : std::false_type
+        {
+        };
+
+        template <class T>
+        struct is_constrained<T, std::void_t<typename constrained_type<T>::type>> : std::true_type
+        {
+        };
+
+        // Only sp_container<T> itself; types deriving from it (constrained ones included) have their own walkers
+        template <class T>
+        struct size_prefixed_type
+        {
+        };
+
+        template <class T>
+        struct size_prefixed_type<plakpacs::sp_container<T>>
+        {
+            using type = T;
+        };
+
+        template <class T, typename = std::void_t<>>
+        struct is_size_prefixed : std::false_type
+        {
+        };
+
+        template <class T>
+        struct is_size_prefixed<T, std::void_t<typename size_prefixed_type<T>::type>> : std::true_type
+        {
+        };
+
+        template <class T>
+        constexpr binary_kind binary_kind_of()
+        {
+            if constexpr (bpacs::has_bp_reflection<T>::value)
+                return binary_kind::object;
+            else if constexpr (bpjson::detail::is_std_optional<T>::value)
+                return binary_kind::optional;
+            else if constexpr (is_constrained<T>::value)
+                return binary_kind::constrained;
+            else if constexpr (is_size_prefixed<T>::value)
+            {
+                using inner = typename size_prefixed_type<T>::type;
+
+                // sp_array can't be read back by plakpacs, and the rest has no JSON counterpart worth a direct path
+                if constexpr (std::is_same_v<inner, std::string>)
+                    return binary_kind::size_prefixed_string;
+                else if constexpr (bpjson::detail::is_growable_array<inner>::value)
+                    return binary_kind::size_prefixed_array;
+                else
+                    return binary_kind::fallback;
+            }
+            else if constexpr (std::is_same_v<T, std::string>)
+                return binary_kind::string;
+            else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+                return binary_kind::scalar;
+            else if constexpr (bpjson::detail::is_fixed_array<T>::value)
+                return binary_kind::fixed_array;
+            else if constexpr (bpjson::detail::is_growable_array<T>::value)
+                return binary_kind::array;
+            else
+                return binary_kind::fallback;
+        }
+
+        template <class Json, typename = std::void_t<>>
+        struct has_string_view : std::false_type
+        {
+        };
+
+        template <class Json>
+        struct has_string_view<
+            Json, std::void_t<decltype(bpjson::json_traits<Json>::get_string_view(std::declval<const Json &>()))>>
+            : std::true_type
+        {
+        };
+
+        /// @brief What a field missing from the JSON holds after bpjson reads into a fresh T: its default member
+        /// initializer, or a value-initialized value in default_initialize mode. Built once per type.
+        template <class T, std::size_t I>
+        const typename bpacs::field_meta<T, I>::type &missing_field_value(const bpjson::serialization_settings &settings)
+        {
+            static const T defaults{};
+            static const typename bpacs::field_meta<T, I>::type value_initialized{};
+
+            if (settings.missing_fields_mode == bpjson::missing_fields::default_initialize)
+                return value_initialized;
+
+            return bpacs::get_const_field<T, I>(defaults).value();
+        }
+    } // namespace detail
+
+    /// @brief Converts between JSON and plakpacs binary for reflected types without building the C++ object in
+    /// between: JSON values are written out as plakpacs bytes field by field, and plakpacs bytes are read straight
+    /// into JSON text. The bytes are the ones plakpacs::serializer writes and reads for the same type, and the JSON
+    /// follows bpjson's rules (missing fields, optionals as null, text as text_writer writes it).
+    ///
+    ///     plakpacs::write_stream stream;
+    ///     bptranscode::transcoder<nlohmann::json>::json_to_binary<Packet>(nlohmann::json::parse(text), stream);
+    ///
+    /// Objects, optionals, strings, numbers, enums, arrays and size-prefixed strings and vectors have direct paths.
+    /// Everything else, custom binary_walker specializations included, is decoded into its own C++ value and
+    /// encoded again through plakpacs and bpjson, so it comes out the same either way.
+    template <class Json>
+    class transcoder
+    {
+    public:
+        /// @brief Appends the plakpacs encoding of the T in json to stream. Constraints aren't checked, just as
+        /// plakpacs::serializer::write doesn't; the reading side does that.
+        /// @param stream Anything with write(const T&), write(begin, end) and write(char), like plakpacs::write_stream
+        template <class T, class Stream>
+        static void json_to_binary(const Json &json, Stream &stream, const bpjson::serialization_settings &settings = {})
+        {
+            write_binary<T>(stream, json, settings);
+        }
+
+        /// @brief Reads a T from stream and appends it to out as JSON text.
+        /// @param stream Anything with read<T>(), can_read(), bytes(), position() and skip(n), like plakpacs::read_stream
+        template <class T, class Stream>
+        static void binary_to_json(Stream &stream, std::string &out, const bpjson::serialization_settings &settings = {})
+        {
+            bpjson::detail::string_output output(out);
+            write_text<T>(output, stream, settings);
+        }
+
+        template <class T, class Stream>
+        static std::string binary_to_json(Stream &stream, const bpjson::serialization_settings &settings = {})
+        {
+            std::string text;
+            binary_to_json<T>(stream, text, settings);
+            return text;
+        }
+
+        /// @brief Same as binary_to_json, but writes the text in chunks to sink(const char* data, std::size_t size).
+        template <class T, class Stream, class Sink>
+        static void binary_to_json_sink(Stream &stream, Sink &&sink, const bpjson::serialization_settings &settings = {})
+        {
+            bpjson::detail::buffered_output<std::remove_reference_t<Sink>> output(sink);
+            write_text<T>(output, stream, settings);
+            output.flush();
+        }
+
+    private:
+        using traits = bpjson::json_traits<Json>;
+
+        // plakpacs refuses to read containers larger than this
+        static constexpr std::uint32_t max_container_size = 65536;
+
+        ////////////////////////////////////////////////////////////////////
+
+        template <class T, class Stream>
+        static void write_binary(Stream &stream, const Json &json, const bpjson::serialization_settings &settings)
+        {
+            using kind = detail::binary_kind;
+            constexpr auto type = detail::binary_kind_of<T>();
+
+            if constexpr (type == kind::object)
+            {
+                write_object<T>(stream, json, settings, std::make_index_sequence<bpjson::field_count<T>::value>{});
+            }
+            else if constexpr (type == kind::optional)
+            {
+                bool has = !traits::is_null(json);
+                stream.write(has);
+
+                if (has)
+                    write_binary<typename T::value_type>(stream, json, settings);
+            }
+            else if constexpr (type == kind::constrained)
+            {
+                write_binary<typename detail::constrained_type<T>::type>(stream, json, settings);
+            }
+            else if constexpr (type == kind::size_prefixed_string)
+            {
+                with_string(json, [&stream](std::string_view value) {
+                    stream.write(static_cast<std::uint32_t>(value.size()));
+                    write_chars(stream, value);
+                });
+            }
+            else if constexpr (type == kind::size_prefixed_array)
+            {
+                using element = typename detail::size_prefixed_type<T>::type::value_type;
+                auto &&elements = traits::get_elements(json);
+
+                stream.write(static_cast<std::uint32_t>(std::size(elements)));
+
+                for (auto &&item : elements)
+                    write_binary<element>(stream, item, settings);
+            }
+            else if constexpr (type == kind::string)
+            {
+                with_string(json, [&stream](std::string_view value) { write_chars(stream, value); });
+            }
+            else if constexpr (type == kind::scalar)
+            {
+                stream.write(traits::template get_typed_value<T>(json));
+            }
+            else if constexpr (type == kind::fixed_array)
+            {
+                // Extra elements are dropped and missing ones left value-initialized, as reading into T would
+                using element = typename T::value_type;
+                constexpr auto N = std::tuple_size<T>::value;
+
+                std::size_t count = 0;
+                for (auto &&item : traits::get_elements(json))
+                {
+                    if (count == N)
+                        break;
+
+                    write_binary<element>(stream, item, settings);
+                    count++;
+                }
+
+                for (; count < N; count++)
+                    plakpacs::serializer::write(stream, element{});
+            }
+            else if constexpr (type == kind::array)
+            {
+                for (auto &&item : traits::get_elements(json))
+                    write_binary<typename T::value_type>(stream, item, settings);
+            }
+            else
+            {
+                plakpacs::serializer::write(stream, bpjson::json_serializer<Json>::template read<T>(json, settings));
+            }
+        }
+
+        template <class T, class Stream, std::size_t... I>
+        static void write_object(Stream &stream, const Json &json, const bpjson::serialization_settings &settings,
+                                 std::index_sequence<I...>)
+        {
+            (write_field<T, I>(stream, json, settings), ...);
+        }
+
+        // Fields go out in declaration order, whatever order their keys came in
+        template <class T, std::size_t I, class Stream>
+        static void write_field(Stream &stream, const Json &json, const bpjson::serialization_settings &settings)
+        {
+            using meta = bpacs::field_meta<T, I>;
+            using field_type = typename meta::type;
+
+            transcode_field<meta>("json_to_binary", [&] {
+                if ((settings.missing_fields_mode == bpjson::missing_fields::throw_exception &&
+                     !bpjson::json_walker<Json, T>::force_optional && !bpjson::json_fields_optional<T>::value) ||
+                    traits::subkey_exists(json, meta::name))
+                {
+                    write_binary<field_type>(stream, traits::get_existing_subkey(json, meta::name), settings);
+                }
+                else
+                {
+                    plakpacs::serializer::write(stream, detail::missing_field_value<T, I>(settings));
+                }
+            });
+        }
+
+        template <class F>
+        static void with_string(const Json &json, F &&f)
+        {
+            if constexpr (detail::has_string_view<Json>::value)
+                f(traits::get_string_view(json));
+            else
+                f(std::string_view(traits::template get_typed_value<std::string>(json)));
+        }
+
+        template <class Stream>
+        static void write_chars(Stream &stream, std::string_view value)
+        {
+            stream.write(value.begin(), value.end());
+            stream.write('\0');
+        }
+
+        ////////////////////////////////////////////////////////////////////
+
+        template <class T, class Output, class Stream>
+        static void write_text(Output &out, Stream &stream, const bpjson::serialization_settings &settings)
+        {
+            using kind = detail::binary_kind;
+            constexpr auto type = detail::binary_kind_of<T>();
+
+            if constexpr (type == kind::object)
+            {
+                out.put('{');
+                write_text_fields<T>(out, stream, settings, std::make_index_sequence<bpjson::field_count<T>::value>{});
+                out.put('}');
+            }
+            else if constexpr (type == kind::optional)
+            {
+                // plakpacs leaves optionals at the very end of the stream empty when their flag isn't there
+                if (stream.can_read() && stream.template read<bool>())
+                    write_text<typename T::value_type>(out, stream, settings);
+                else
+                    out.append("null", 4);
+            }
+            else if constexpr (type == kind::constrained)
+            {
+                // Constraints look at the whole value, so this one is read for real to check them
+                auto value = plakpacs::serializer::read<T>(stream);
+
+                bpjson::text_writer<Json>::write_value(
+                    out, static_cast<const typename detail::constrained_type<T>::type &>(value), settings);
+            }
+            else if constexpr (type == kind::size_prefixed_string)
+            {
+                auto size = read_size(stream);
+
+                // plakpacs skips the terminator after the characters without looking at it
+                bpjson::text_writer<Json>::write_string(out, view_chars(stream, size));
+                stream.skip(size + 1);
+            }
+            else if constexpr (type == kind::size_prefixed_array)
+            {
+                using element = typename detail::size_prefixed_type<T>::type::value_type;
+                auto size = read_size(stream);
+
+                out.put('[');
+
+                for (std::uint32_t i = 0; i < size; i++)
+                {
+                    if (i > 0)
+                        out.put(',');
+
+                    write_text<element>(out, stream, settings);
+                }
+
+                out.put(']');
+            }
+            else if constexpr (type == kind::string)
+            {
+                auto value = view_string(stream);
+
+                bpjson::text_writer<Json>::write_string(out, value);
+                stream.skip(value.size() + 1);
+            }
+            else if constexpr (type == kind::scalar)
+            {
+                auto value = stream.template read<T>();
+
+                if constexpr (std::is_enum_v<T>)
+                    bpjson::text_writer<Json>::write_value(out, static_cast<std::underlying_type_t<T>>(value), settings);
+                else
+                    bpjson::text_writer<Json>::write_value(out, value, settings);
+            }
+            else if constexpr (type == kind::fixed_array)
+            {
+                out.put('[');
+
+                for (std::size_t i = 0; i < std::tuple_size<T>::value; i++)
+                {
+                    if (i > 0)
+                        out.put(',');
+
+                    write_text<typename T::value_type>(out, stream, settings);
+                }
+
+                out.put(']');
+            }
+            else if constexpr (type == kind::array)
+            {
+                static_assert(sizeof(T) == 0, "bptranscode::transcoder: plakpacs can't read containers without a size "
+                                              "prefix; use sp_container or a fixed-size array");
+            }
+            else
+            {
+                bpjson::text_writer<Json>::write_value(out, plakpacs::serializer::read<T>(stream), settings);
+            }
+        }
+
+        template <class T, class Output, class Stream, std::size_t... I>
+        static void write_text_fields(Output &out, Stream &stream, const bpjson::serialization_settings &settings,
+                                      std::index_sequence<I...>)
+        {
+            (write_text_field<T, I>(out, stream, settings), ...);
+        }
+
+        template <class T, std::size_t I, class Output, class Stream>
+        static void write_text_field(Output &out, Stream &stream, const bpjson::serialization_settings &settings)
+        {
+            using meta = bpacs::field_meta<T, I>;
+
+            transcode_field<meta>("binary_to_json", [&] {
+                if constexpr (I > 0)
+                    out.put(',');
+
+                auto &key = bpjson::detail::key_literal<T, I>;
+                out.append(key.data(), key.size());
+                write_text<typename meta::type>(out, stream, settings);
+            });
+        }
+
+        template <class Stream>
+        static std::uint32_t read_size(Stream &stream)
+        {
+            auto size = stream.template read<std::uint32_t>();
+
+            if (size > max_container_size)
+                throw std::runtime_error("invalid container size " + std::to_string(size));
+
+            return size;
+        }
+
+        // The characters stay in the stream's buffer; the caller skips past them once they've been written out
+        template <class Stream>
+        static std::string_view view_chars(Stream &stream, std::size_t size)
+        {
+            auto &bytes = stream.bytes();
+            auto position = stream.position();
+
+            if (size >= std::size(bytes) - position)
+                throw std::runtime_error("string runs past the end of the stream");
+
+            return std::string_view(reinterpret_cast<const char *>(std::data(bytes)) + position, size);
+        }
+
+        template <class Stream>
+        static std::string_view view_string(Stream &stream)
+        {
+            auto &bytes = stream.bytes();
+            auto position = stream.position();
+            auto begin = reinterpret_cast<const char *>(std::data(bytes)) + position;
+            auto end = static_cast<const char *>(std::memchr(begin, '\0', std::size(bytes) - position));
+
+            if (!end)
+                throw std::runtime_error("string runs past the end of the stream");
+
+            return std::string_view(begin, (std::size_t)(end - begin));
+        }
+
+        ////////////////////////////////////////////////////////////////////
+
+        template <class Meta, class F>
+        static void transcode_field(const char *operation, F &&f)
+        {
+            try
+            {
+                f();
+            }
+            catch (const std::exception &e)
+            {
+                throw std::runtime_error(std::string("bptranscode::transcoder.") + operation + ": field '" +
+                                         Meta::holder + "." + Meta::name + "' caught exception - " + e.what());
+            }
+            catch (...)
+            {
+                throw std::runtime_error(std::string("bptranscode::transcoder.") + operation + ": field '" +
+                                         Meta::holder + "." + Meta::name + "' caught unknown exception");
+            }
+        }
+    };
+} // namespace bptranscode
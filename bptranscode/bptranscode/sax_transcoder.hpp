@@ -0,0 +1,531 @@
+//
+//  sax_transcoder.hpp
+//  bptranscode
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "bptranscode.hpp"
+#include <bpjson/nlohmann_traits.hpp>
+#include <bpjson/sax_handler.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bptranscode
+{
+    namespace detail
+    {
+        /// @brief The write side of a little-endian plakpacs stream over a byte vector, for plakpacs::serializer to write
+        /// into.
+        class byte_output
+        {
+        public:
+            explicit byte_output(std::vector<std::uint8_t> &bytes) : _bytes(&bytes)
+            {
+            }
+
+            template <class T>
+            void write(const T &value)
+            {
+                auto size = _bytes->size();
+                _bytes->resize(size + sizeof(T));
+                plakpacs::store<plakpacs::little_endian>(_bytes->data() + size, value);
+            }
+
+            template <class Iter>
+            void write(Iter begin, Iter end)
+            {
+                _bytes->insert(_bytes->end(), begin, end);
+            }
+
+            void write(char value)
+            {
+                _bytes->push_back((std::uint8_t)value);
+            }
+
+            void write(unsigned char value)
+            {
+                _bytes->push_back(value);
+            }
+
+        private:
+            std::vector<std::uint8_t> *_bytes;
+        };
+
+        /// @brief What an optional or constrained type hands its JSON value on to.
+        template <class T>
+        struct wrapped_type
+        {
+            using type = T;
+        };
+
+        template <class T>
+        struct wrapped_type<std::optional<T>>
+        {
+            using type = T;
+        };
+
+        template <class T, class... Cs>
+        struct wrapped_type<plakpacs::constrained<T, Cs...>>
+        {
+            using type = T;
+        };
+
+        template <class T, binary_kind Kind = binary_kind_of<T>()>
+        struct element_type
+        {
+            using type = typename T::value_type;
+        };
+
+        template <class T>
+        struct element_type<T, binary_kind::size_prefixed_array>
+        {
+            using type = typename size_prefixed_type<T>::type::value_type;
+        };
+    } // namespace detail
+
+    /// @brief Turns JSON text straight into plakpacs bytes from nlohmann's SAX events, with neither a DOM nor the C++
+    /// object in between. Values are encoded as they come in; an object whose keys didn't come in declaration order
+    /// (or had some missing or repeated) has its fields put back in order once it ends. The bytes are the ones
+    /// transcoder::json_to_binary writes for the same JSON.
+    ///
+    /// Types without a direct path are built as a small DOM of just their own value, read into a C++ value and written
+    /// through plakpacs::serializer, like with transcoder.
+    ///
+    /// A transcoder keeps its buffers between calls, so reusing one for many messages doesn't allocate for them again.
+    /// Input is anything Json::sax_parse takes.
+    template <class Json>
+    class sax_transcoder
+    {
+    public:
+        explicit sax_transcoder(const bpjson::serialization_settings &settings = {}) : _handler(settings)
+        {
+        }
+
+        /// @brief Appends the plakpacs encoding of the T in input to stream.
+        template <class T, class Input, class Stream>
+        void json_to_binary(Input &&input, Stream &stream)
+        {
+            static_assert(std::is_same_v<typename plakpacs::stream_byte_order<Stream>::type, plakpacs::little_endian>,
+                          "bptranscode::sax_transcoder: only writes to little-endian streams");
+
+            auto &bytes = json_to_bytes<T>(std::forward<Input>(input));
+            stream.write(bytes.begin(), bytes.end());
+        }
+
+        /// @brief Returns the plakpacs encoding of the T in input. The bytes belong to the transcoder and stay valid until
+        /// its next call.
+        template <class T, class Input>
+        const std::vector<std::uint8_t> &json_to_bytes(Input &&input)
+        {
+            _handler.reset(slot_of<T>());
+
+            if (!Json::sax_parse(std::forward<Input>(input), &_handler))
+                throw std::runtime_error("bptranscode::sax_transcoder.json_to_binary: " + _handler.error);
+
+            return _handler.out;
+        }
+
+    private:
+        using string_t = typename Json::string_t;
+        using number_integer_t = typename Json::number_integer_t;
+        using number_unsigned_t = typename Json::number_unsigned_t;
+        using number_float_t = typename Json::number_float_t;
+        using binary_kind = detail::binary_kind;
+
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        /// @brief What the transcoder writes to: the bytes, and where each field of the objects being encoded lies in them.
+        struct encoding
+        {
+            struct frame_state
+            {
+                // Where the encoding of the contents starts in out
+                std::size_t start = 0;
+
+                // Reflected objects: where their field spans start in spans, and the field being encoded
+                std::size_t spans = 0;
+                std::size_t field = npos;
+            };
+
+            std::vector<std::uint8_t> out;
+
+            // Where each field of the objects being encoded lies in out, as [first, last)
+            std::vector<std::pair<std::size_t, std::size_t>> spans;
+
+            std::vector<std::uint8_t> scratch;
+
+            void reset()
+            {
+                out.clear();
+                spans.clear();
+            }
+
+            template <class V>
+            void put(const V &value)
+            {
+                detail::byte_output(out).write(value);
+            }
+
+            void put_chars(std::string_view value)
+            {
+                out.insert(out.end(), value.begin(), value.end());
+                out.push_back(0);
+            }
+
+            /// @brief Writes count value-initialized Vs, for fields and elements that aren't in the JSON.
+            template <class V>
+            void pad(std::size_t count)
+            {
+                detail::byte_output output(out);
+
+                for (std::size_t i = 0; i < count; i++)
+                    plakpacs::serializer::write(output, V{});
+            }
+
+            void close_field(frame_state &f)
+            {
+                if (f.field != npos)
+                    spans[f.spans + f.field].second = out.size();
+
+                f.field = npos;
+            }
+
+            /// @brief Puts an object's fields back in declaration order, leaving out bytes no field points at.
+            void reorder(const frame_state &f, std::size_t fields)
+            {
+                scratch.assign(out.begin() + f.start, out.end());
+                out.resize(f.start);
+
+                for (std::size_t i = 0; i < fields; i++)
+                {
+                    auto [first, last] = spans[f.spans + i];
+                    out.insert(out.end(), scratch.begin() + (first - f.start), scratch.begin() + (last - f.start));
+                }
+            }
+        };
+
+        // The encoding is all there is to write to, so slots and frames never have a target
+        using handler = bpjson::detail::sax_handler<Json, encoding>;
+        using value_ops = typename handler::value_ops;
+        using slot = typename handler::slot;
+        using frame_ops = typename handler::frame_ops;
+        using frame = typename handler::frame;
+
+        template <class T>
+        static constexpr slot slot_of()
+        {
+            return {nullptr, &encoder<T>::ops};
+        }
+
+        static frame &push_frame(handler &h, const frame_ops *ops)
+        {
+            auto &result = h.push_frame(nullptr, ops);
+            result.start = h.out.size();
+            return result;
+        }
+
+        static void push_object(handler &h, const frame_ops *ops, std::size_t fields)
+        {
+            push_frame(h, ops).spans = h.spans.size();
+            h.spans.resize(h.spans.size() + fields, {npos, npos});
+        }
+
+        template <class T>
+        struct encoder
+        {
+            static constexpr binary_kind kind = detail::binary_kind_of<T>();
+            using next = encoder<typename detail::wrapped_type<T>::type>;
+
+            static void null(handler &h, void *target)
+            {
+                // Like the DOM path, null leaves containers empty
+                if constexpr (kind == binary_kind::optional)
+                    h.put(false);
+                else if constexpr (kind == binary_kind::constrained)
+                    next::null(h, target);
+                else if constexpr (kind == binary_kind::size_prefixed_array)
+                    h.put(std::uint32_t(0));
+                else if constexpr (kind == binary_kind::array)
+                    return;
+                else if constexpr (kind == binary_kind::fixed_array)
+                    h.template pad<typename T::value_type>(std::tuple_size<T>::value);
+                else if constexpr (kind == binary_kind::fallback)
+                    finish(h, target, Json(nullptr));
+                else
+                    type_error("null");
+            }
+
+            static void boolean(handler &h, void *target, bool value)
+            {
+                if constexpr (kind == binary_kind::scalar)
+                    put_scalar(h, value);
+                else if constexpr (kind == binary_kind::optional)
+                {
+                    h.put(true);
+                    next::boolean(h, target, value);
+                }
+                else if constexpr (kind == binary_kind::constrained)
+                    next::boolean(h, target, value);
+                else if constexpr (kind == binary_kind::fallback)
+                    finish(h, target, Json(value));
+                else
+                    type_error("boolean");
+            }
+
+            template <class V>
+            static void number(handler &h, void *target, V value)
+            {
+                // nlohmann won't read numbers into booleans either
+                if constexpr (kind == binary_kind::scalar && !std::is_same_v<T, bool>)
+                    put_scalar(h, value);
+                else if constexpr (kind == binary_kind::optional)
+                {
+                    h.put(true);
+                    next::number(h, target, value);
+                }
+                else if constexpr (kind == binary_kind::constrained)
+                    next::number(h, target, value);
+                else if constexpr (kind == binary_kind::fallback)
+                    finish(h, target, Json(value));
+                else
+                    type_error("number");
+            }
+
+            static void string(handler &h, void *target, string_t &value)
+            {
+                if constexpr (kind == binary_kind::string)
+                {
+                    h.put_chars(value);
+                }
+                else if constexpr (kind == binary_kind::size_prefixed_string)
+                {
+                    h.put(static_cast<std::uint32_t>(value.size()));
+                    h.put_chars(value);
+                }
+                else if constexpr (kind == binary_kind::optional)
+                {
+                    h.put(true);
+                    next::string(h, target, value);
+                }
+                else if constexpr (kind == binary_kind::constrained)
+                    next::string(h, target, value);
+                else if constexpr (kind == binary_kind::fallback)
+                    finish(h, target, Json(value));
+                else
+                    type_error("string");
+            }
+
+            static void start_object(handler &h, void *target)
+            {
+                if constexpr (kind == binary_kind::object)
+                    push_object(h, &object_frame<T>::ops, bpjson::field_count<T>::value);
+                else if constexpr (kind == binary_kind::optional)
+                {
+                    h.put(true);
+                    next::start_object(h, target);
+                }
+                else if constexpr (kind == binary_kind::constrained)
+                    next::start_object(h, target);
+                else if constexpr (kind == binary_kind::fallback)
+                    h.begin_dom(Json::object(), target, &finish);
+                else
+                    type_error("object");
+            }
+
+            static void start_array(handler &h, void *target)
+            {
+                if constexpr (kind == binary_kind::size_prefixed_array)
+                {
+                    // The size goes in once the array ends
+                    h.put(std::uint32_t(0));
+                    push_frame(h, &array_frame<T>::ops);
+                }
+                else if constexpr (kind == binary_kind::array || kind == binary_kind::fixed_array)
+                    push_frame(h, &array_frame<T>::ops);
+                else if constexpr (kind == binary_kind::optional)
+                {
+                    h.put(true);
+                    next::start_array(h, target);
+                }
+                else if constexpr (kind == binary_kind::constrained)
+                    next::start_array(h, target);
+                else if constexpr (kind == binary_kind::fallback)
+                    h.begin_dom(Json::array(), target, &finish);
+                else
+                    type_error("array");
+            }
+
+            template <class V>
+            static void put_scalar(handler &h, V value)
+            {
+                if constexpr (std::is_enum_v<T>)
+                    h.put(static_cast<T>(static_cast<std::underlying_type_t<T>>(value)));
+                else
+                    h.put(static_cast<T>(value));
+            }
+
+            static void finish(handler &h, void *, Json &&json)
+            {
+                if constexpr (kind == binary_kind::fallback)
+                {
+                    detail::byte_output output(h.out);
+                    plakpacs::serializer::write(output, bpjson::json_serializer<Json>::template read<T>(json, h.settings));
+                }
+            }
+
+            [[noreturn]] static void type_error(const char *actual)
+            {
+                const char *expected = "number";
+
+                if constexpr (kind == binary_kind::object)
+                    expected = "object";
+                else if constexpr (kind == binary_kind::size_prefixed_array || kind == binary_kind::array ||
+                                   kind == binary_kind::fixed_array)
+                    expected = "array";
+                else if constexpr (kind == binary_kind::string || kind == binary_kind::size_prefixed_string)
+                    expected = "string";
+                else if constexpr (std::is_same_v<T, bool>)
+                    expected = "boolean";
+
+                throw std::runtime_error(std::string("type must be ") + expected + ", but is " + actual);
+            }
+
+            static constexpr value_ops ops{&null,
+                                           &boolean,
+                                           &number<number_integer_t>,
+                                           &number<number_unsigned_t>,
+                                           &number<number_float_t>,
+                                           &string,
+                                           &start_object,
+                                           &start_array};
+        };
+
+        template <class T, class Indices>
+        struct field_ops;
+
+        template <class T, std::size_t... I>
+        struct field_ops<T, std::index_sequence<I...>>
+        {
+            static constexpr slot slots[] = {slot_of<typename bpacs::field_meta<T, I>::type>()...};
+        };
+
+        template <class T>
+        struct object_frame
+        {
+            static constexpr std::size_t size = bpjson::field_count<T>::value;
+
+            static slot key(handler &h, frame &f, string_t &name)
+            {
+                h.close_field(f);
+
+                auto entry = bpjson::field_table<T>::find(name);
+
+                if (!entry)
+                {
+                    f.key = {};
+                    return {};
+                }
+
+                // The last of several equal keys wins; the bytes of the earlier ones are dropped when the object ends
+                h.spans[f.spans + entry->index].first = h.out.size();
+                f.field = entry->index;
+                f.key = entry->name;
+                return field_ops<T, std::make_index_sequence<size>>::slots[entry->index];
+            }
+
+            static void end(handler &h, frame &f)
+            {
+                h.close_field(f);
+                add_missing(h, f, std::make_index_sequence<size>{});
+
+                // Keys usually come in declaration order, which leaves nothing to do
+                auto position = f.start;
+                bool ordered = true;
+
+                for (std::size_t i = 0; i < size && ordered; i++)
+                {
+                    auto [first, last] = h.spans[f.spans + i];
+                    ordered = first == position;
+                    position = last;
+                }
+
+                if (!ordered || position != h.out.size())
+                    h.reorder(f, size);
+
+                h.spans.resize(f.spans);
+            }
+
+            template <std::size_t... I>
+            static void add_missing(handler &h, frame &f, std::index_sequence<I...>)
+            {
+                (add_missing<I>(h, f), ...);
+            }
+
+            template <std::size_t I>
+            static void add_missing(handler &h, frame &f)
+            {
+                using meta = bpacs::field_meta<T, I>;
+                auto &span = h.spans[f.spans + I];
+
+                if (span.first != npos)
+                    return;
+
+                if (h.settings.missing_fields_mode == bpjson::missing_fields::throw_exception &&
+                    !bpjson::json_walker<Json, T>::force_optional && !bpjson::json_fields_optional<T>::value)
+                    throw std::runtime_error(std::string("field '") + meta::name + "' is missing");
+
+                span.first = h.out.size();
+                detail::byte_output output(h.out);
+                plakpacs::serializer::write(output, detail::missing_field_value<T, I>(h.settings));
+                span.second = h.out.size();
+            }
+
+            static constexpr frame_ops ops{false, &key, nullptr, &end};
+        };
+
+        template <class T>
+        struct array_frame
+        {
+            static constexpr binary_kind kind = detail::binary_kind_of<T>();
+            using element = typename detail::element_type<T>::type;
+
+            static slot element_ops(handler &, frame &f)
+            {
+                // Fixed arrays drop whatever doesn't fit, like reading into them does
+                if constexpr (kind == binary_kind::fixed_array)
+                    return f.count < std::tuple_size<T>::value ? slot_of<element>() : slot{};
+                else
+                    return slot_of<element>();
+            }
+
+            static void end(handler &h, frame &f)
+            {
+                if constexpr (kind == binary_kind::size_prefixed_array)
+                {
+                    auto size = static_cast<std::uint32_t>(f.count);
+                    plakpacs::store<plakpacs::little_endian>(h.out.data() + f.start - sizeof(size), size);
+                }
+                else if constexpr (kind == binary_kind::fixed_array)
+                {
+                    if (f.count < std::tuple_size<T>::value)
+                        h.template pad<element>(std::tuple_size<T>::value - f.count);
+                }
+            }
+
+            static constexpr frame_ops ops{true, nullptr, &element_ops, &end};
+        };
+
+        handler _handler;
+    };
+} // namespace bptranscode
@@ -0,0 +1,528 @@
+//
+//  loadgen.cpp
+//  gspp-loadgen
+//
+//  Created on 18.10.2026.
+//
+
+// Opens a number of DualConnections to an in-process echo server over loopback, drives a configurable mix
+// of stream and datagram packets through them and reports throughput and round-trip latency percentiles.
+// The client side of every link can be passed through a NetworkImpairment to mimic production conditions.
+
+#include <bacs/bacs.hpp>
+#include <bacs/accept_engine.hpp>
+#include <plakpacs/plakpacs.hpp>
+#include <gspp/datagram_client.hpp>
+#include <gspp/datagram_connection.hpp>
+#include <gspp/dual_connection.hpp>
+#include <gspp/network_impairment.hpp>
+#include <gspp/packet_handlers.hpp>
+#include <gspp/packet_serializer.hpp>
+#include <gspp/stream_client.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+namespace loadgen
+{
+    using tcp = boost::asio::ip::tcp;
+    using udp = boost::asio::ip::udp;
+    using Clock = std::chrono::steady_clock;
+
+    struct Header
+    {
+        uint16_t id;
+    };
+
+    struct EchoPacket
+    {
+        uint32_t connection;
+        uint64_t sent_at;
+        plakpacs::sp_vector<uint8_t> payload;
+    };
+
+    constexpr uint16_t EchoPacketId = 1;
+}
+
+BP_DEFINE_REFL_FIELD(loadgen::Header, 0, id)
+
+BP_DEFINE_REFL_FIELD(loadgen::EchoPacket, 0, connection)
+BP_DEFINE_REFL_FIELD(loadgen::EchoPacket, 1, sent_at)
+BP_DEFINE_REFL_FIELD(loadgen::EchoPacket, 2, payload)
+
+namespace gspp
+{
+    template<>
+    struct PacketSerializer<loadgen::Header>
+    {
+        template<class ReadStream>
+        static loadgen::Header Deserialize(ReadStream& stream)
+        {
+            return plakpacs::serializer::read<loadgen::Header>(stream);
+        }
+    };
+
+    template<>
+    struct PacketSerializer<loadgen::EchoPacket>
+    {
+        template<class WriteStream>
+        static WriteStream Serialize(const loadgen::EchoPacket& packet)
+        {
+            WriteStream stream;
+            plakpacs::serializer::write(stream, loadgen::Header{ loadgen::EchoPacketId });
+            plakpacs::serializer::write(stream, packet);
+            return stream;
+        }
+    };
+}
+
+namespace loadgen
+{
+    using Stream = gspp::StreamClient<tcp>;
+    using Datagram = gspp::DatagramClient<udp>;
+    using DatagramConnection = Datagram::Connection;
+    using Connection = gspp::DualConnection<Stream, Datagram>;
+
+    // Server and client need separate handler registries, which the header id extractor type tells apart
+    template<class Side>
+    struct HeaderIdExtractor
+    {
+        static uint16_t Extract(const Header& header)
+        {
+            return header.id;
+        }
+    };
+
+    template<class Schema>
+    struct SchemaIdExtractor
+    {
+        static uint16_t Extract()
+        {
+            return EchoPacketId;
+        }
+    };
+
+    struct ServerSide;
+    struct ClientSide;
+
+    using ServerHandlers = gspp::HandlerSystem<Connection, Header, uint16_t, HeaderIdExtractor<ServerSide>, SchemaIdExtractor>;
+    using ClientHandlers = gspp::HandlerSystem<Connection, Header, uint16_t, HeaderIdExtractor<ClientSide>, SchemaIdExtractor>;
+
+    struct Options
+    {
+        std::size_t connections = 1000;
+        double duration = 10.0;
+        double drain = 1.0;
+        double rate = 20.0;
+        double stream_share = 0.5;
+        std::size_t payload = 64;
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        gspp::ImpairmentSettings impairment;
+        bool json = false;
+    };
+
+    class LatencyRecorder
+    {
+    public:
+        void Record(uint64_t sent_at, std::size_t bytes)
+        {
+            auto now = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+
+            std::lock_guard lg{ _lock };
+            _samples.push_back(now - sent_at);
+            _bytes += bytes;
+        }
+
+        struct Summary
+        {
+            std::size_t received = 0;
+            std::size_t bytes = 0;
+            double p50 = 0;
+            double p99 = 0;
+            double p999 = 0;
+            double max = 0;
+        };
+
+        Summary Summarize()
+        {
+            std::lock_guard lg{ _lock };
+
+            Summary summary;
+            summary.received = _samples.size();
+            summary.bytes = _bytes;
+
+            if (_samples.empty())
+                return summary;
+
+            std::sort(_samples.begin(), _samples.end());
+
+            auto percentile = [this](double p)
+            {
+                auto index = std::min(_samples.size() - 1, (std::size_t)(p * _samples.size()));
+                return _samples[index] / 1000.0;
+            };
+
+            summary.p50 = percentile(0.50);
+            summary.p99 = percentile(0.99);
+            summary.p999 = percentile(0.999);
+            summary.max = _samples.back() / 1000.0;
+            return summary;
+        }
+
+    private:
+        std::mutex _lock;
+        std::vector<uint64_t> _samples;
+        std::size_t _bytes = 0;
+    };
+
+    LatencyRecorder streamLatency;
+    LatencyRecorder datagramLatency;
+    std::atomic<std::size_t> streamSent{ 0 };
+    std::atomic<std::size_t> datagramSent{ 0 };
+
+    uint64_t Timestamp()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "--json")
+            {
+                options.json = true;
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+                return false;
+            }
+
+            double value = std::atof(argv[++i]);
+
+            if (arg == "--connections")
+                options.connections = (std::size_t)value;
+            else if (arg == "--duration")
+                options.duration = value;
+            else if (arg == "--drain")
+                options.drain = value;
+            else if (arg == "--rate")
+                options.rate = value;
+            else if (arg == "--stream-share")
+                options.stream_share = std::clamp(value, 0.0, 1.0);
+            else if (arg == "--payload")
+                options.payload = (std::size_t)value;
+            else if (arg == "--threads")
+                options.threads = std::max<std::size_t>(1, (std::size_t)value);
+            else if (arg == "--latency-ms")
+                options.impairment.latency = std::chrono::microseconds((long long)(value * 1000));
+            else if (arg == "--jitter-ms")
+                options.impairment.jitter = std::chrono::microseconds((long long)(value * 1000));
+            else if (arg == "--loss")
+                options.impairment.loss = value;
+            else if (arg == "--reorder")
+                options.impairment.reorder = value;
+            else if (arg == "--duplicate")
+                options.impairment.duplicate = value;
+            else if (arg == "--bandwidth")
+                options.impairment.bandwidth = (std::size_t)value;
+            else
+            {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+                     "usage: gspp-loadgen [options]\n"
+                     "  --connections N     DualConnections to open (1000)\n"
+                     "  --duration S        seconds to generate load for (10)\n"
+                     "  --drain S           seconds to wait for replies afterwards (1)\n"
+                     "  --rate R            packets per second per connection (20)\n"
+                     "  --stream-share F    share of packets sent over the stream transport (0.5)\n"
+                     "  --payload B         payload bytes per packet (64)\n"
+                     "  --threads N         io threads for each of client and server\n"
+                     "  --latency-ms MS     simulated one-way latency on the client links\n"
+                     "  --jitter-ms MS      simulated jitter\n"
+                     "  --loss P            datagram loss probability\n"
+                     "  --reorder P         datagram reordering probability\n"
+                     "  --duplicate P       datagram duplication probability\n"
+                     "  --bandwidth B       link capacity in bytes per second\n"
+                     "  --json              print the report as a single JSON object\n");
+    }
+
+    void Report(const Options& options, double elapsed)
+    {
+        auto stream = streamLatency.Summarize();
+        auto datagram = datagramLatency.Summarize();
+
+        struct Row
+        {
+            const char* name;
+            std::size_t sent;
+            LatencyRecorder::Summary summary;
+        };
+
+        Row rows[] = { { "stream", streamSent.load(), stream }, { "datagram", datagramSent.load(), datagram } };
+
+        if (options.json)
+        {
+            std::printf("{\"connections\":%zu,\"duration\":%.3f,\"rate\":%.3f,\"payload\":%zu", options.connections, elapsed,
+                        options.rate, options.payload);
+
+            for (auto& row : rows)
+                std::printf(",\"%s\":{\"sent\":%zu,\"received\":%zu,\"packets_per_second\":%.1f,\"bytes_per_second\":%.1f,"
+                            "\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f}",
+                            row.name, row.sent, row.summary.received, row.summary.received / elapsed,
+                            row.summary.bytes / elapsed, row.summary.p50, row.summary.p99, row.summary.p999, row.summary.max);
+
+            std::printf("}\n");
+            return;
+        }
+
+        std::printf("%zu connections, %.2fs, %.1f packets/s each, %zu byte payloads\n", options.connections, elapsed,
+                    options.rate, options.payload);
+        std::printf("%-10s %10s %10s %12s %12s %10s %10s %10s %10s\n", "transport", "sent", "received", "packets/s",
+                    "MB/s", "p50 us", "p99 us", "p999 us", "max us");
+
+        for (auto& row : rows)
+            std::printf("%-10s %10zu %10zu %12.1f %12.3f %10.1f %10.1f %10.1f %10.1f\n", row.name, row.sent,
+                        row.summary.received, row.summary.received / elapsed, row.summary.bytes / elapsed / 1e6,
+                        row.summary.p50, row.summary.p99, row.summary.p999, row.summary.max);
+    }
+
+    void RaiseFileLimit()
+    {
+#if defined(__linux__)
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+#endif
+    }
+
+    int Run(const Options& options)
+    {
+        RaiseFileLimit();
+
+        boost::asio::io_context serverContext;
+        boost::asio::io_context clientContext;
+
+        auto loopback = boost::asio::ip::address_v4::loopback();
+
+        // Server: echoes stream packets back through the handler system and datagrams straight from the socket handler
+        std::mutex serverLock;
+        std::vector<std::shared_ptr<Connection>> serverConnections;
+        uint32_t nextServerId = 0;
+
+        // Every client connects at once, so keep a few accepts in flight
+        bacs::accept_engine<tcp> acceptor{ { serverContext.get_executor() }, tcp::endpoint(loopback, 0),
+            [&](const boost::system::error_code& ec, tcp::socket&& socket)
+            {
+                if (ec.failed())
+                    return;
+
+                std::lock_guard lg{ serverLock };
+
+                auto connection = std::make_shared<Connection>(nextServerId++);
+                connection->SetupStreamClient<ServerHandlers>(std::move(socket));
+                connection->StartReceiveLoop();
+
+                serverConnections.push_back(connection);
+            } };
+        auto serverStreamEp = acceptor.local_endpoint();
+
+        udp::socket serverDatagramSocket{ serverContext, udp::endpoint(loopback, 0) };
+        auto serverDatagramEp = serverDatagramSocket.local_endpoint();
+
+        std::shared_ptr<DatagramConnection> serverDatagrams;
+        serverDatagrams = std::make_shared<DatagramConnection>(std::move(serverDatagramSocket),
+            [&serverDatagrams](udp::endpoint ep, bacs::shared_buffer buffer, std::size_t bytes)
+            {
+                using size_type = bacs::sp_default::size_type;
+
+                if (bytes > sizeof(size_type))
+                {
+                    serverDatagrams->EnqueueBytes(ep, buffer.begin() + sizeof(size_type), bytes - sizeof(size_type));
+                    serverDatagrams->Flush();
+                }
+            }, options.threads);
+
+        // Client: a few shared datagram sockets, one stream per connection
+        auto outgoing = std::make_shared<gspp::NetworkImpairment>(clientContext.get_executor(), options.impairment);
+        auto incoming = std::make_shared<gspp::NetworkImpairment>(clientContext.get_executor(), options.impairment);
+        bool impaired = options.impairment.latency.count() || options.impairment.jitter.count() ||
+                        options.impairment.loss > 0 || options.impairment.reorder > 0 ||
+                        options.impairment.duplicate > 0 || options.impairment.bandwidth;
+
+        std::vector<std::shared_ptr<DatagramConnection>> clientDatagrams;
+        for (std::size_t i = 0; i < options.threads; i++)
+        {
+            auto connection = std::make_shared<DatagramConnection>(udp::socket(clientContext, udp::endpoint(loopback, 0)),
+                [](udp::endpoint, bacs::shared_buffer buffer, std::size_t bytes)
+                {
+                    using size_type = bacs::sp_default::size_type;
+
+                    if (bytes <= sizeof(size_type))
+                        return;
+
+                    plakpacs::read_stream stream{ buffer.begin() + sizeof(size_type), buffer.begin() + bytes };
+                    auto header = plakpacs::serializer::read<Header>(stream);
+
+                    if (header.id == EchoPacketId)
+                        datagramLatency.Record(plakpacs::serializer::read<EchoPacket>(stream).sent_at, bytes);
+                });
+
+            if (impaired)
+                connection->SetImpairment(outgoing, incoming);
+
+            clientDatagrams.push_back(connection);
+        }
+
+        auto serverWorkers = std::make_unique<bacs::io_worker_pool<boost::asio::io_context>>(serverContext, options.threads);
+        auto clientWorkers = std::make_unique<bacs::io_worker_pool<boost::asio::io_context>>(clientContext, options.threads);
+
+        std::vector<std::shared_ptr<Connection>> clients;
+        clients.reserve(options.connections);
+
+        for (std::size_t i = 0; i < options.connections; i++)
+        {
+            tcp::socket socket{ clientContext };
+            boost::system::error_code ec;
+            socket.connect(serverStreamEp, ec);
+
+            if (ec.failed())
+            {
+                std::fprintf(stderr, "connection %zu failed: %s\n", i, ec.message().c_str());
+                break;
+            }
+
+            socket.set_option(tcp::no_delay(true));
+
+            auto connection = std::make_shared<Connection>((uint32_t)i);
+            connection->SetupStreamClient<ClientHandlers>(std::move(socket));
+            connection->ConnectDG(std::make_shared<Datagram>(clientDatagrams[i % clientDatagrams.size()], serverDatagramEp));
+
+            if (impaired)
+                connection->stream()->SetImpairment(outgoing, incoming);
+
+            connection->StartReceiveLoop();
+            clients.push_back(connection);
+        }
+
+        if (clients.empty())
+            return 1;
+
+        // Drive the load from a single thread, pacing the total packet budget against the clock
+        EchoPacket packet;
+        packet.payload.resize(options.payload, 0xAB);
+
+        auto totalRate = options.rate * clients.size();
+        auto start = Clock::now();
+        auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+
+        std::size_t sent = 0;
+        std::size_t next = 0;
+        double streamCredit = 0.0;
+
+        for (auto now = start; now < end; now = Clock::now())
+        {
+            auto due = (std::size_t)(std::chrono::duration<double>(now - start).count() * totalRate);
+
+            for (; sent < due; sent++)
+            {
+                auto& client = clients[next];
+                next = (next + 1) % clients.size();
+
+                packet.connection = client->id();
+                packet.sent_at = Timestamp();
+
+                streamCredit += options.stream_share;
+
+                if (streamCredit >= 1.0)
+                {
+                    streamCredit -= 1.0;
+                    client->stream()->Send(packet);
+                    streamSent++;
+                }
+                else
+                {
+                    client->dg()->Send(packet);
+                    datagramSent++;
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        std::this_thread::sleep_for(std::chrono::duration<double>(options.drain));
+
+        Report(options, elapsed);
+
+        clientWorkers.reset();
+        serverWorkers.reset();
+
+        return 0;
+    }
+}
+
+template<>
+template<>
+loadgen::ServerHandlers::HandlerResult loadgen::ServerHandlers::PacketHandlerFunction<loadgen::EchoPacket>::Handle(
+    loadgen::Connection& connection, const std::pair<loadgen::Header, loadgen::EchoPacket>& packet)
+{
+    connection.stream()->Send(packet.second);
+    return HandlerResult::Continue;
+}
+
+template<>
+template<>
+loadgen::ClientHandlers::HandlerResult loadgen::ClientHandlers::PacketHandlerFunction<loadgen::EchoPacket>::Handle(
+    loadgen::Connection&, const std::pair<loadgen::Header, loadgen::EchoPacket>& packet)
+{
+    loadgen::streamLatency.Record(packet.second.sent_at,
+                                  sizeof(loadgen::Header) + sizeof(uint32_t) + sizeof(uint64_t) + packet.second.payload.size());
+    return HandlerResult::Continue;
+}
+
+static loadgen::ServerHandlers::HandlerRegistrator<loadgen::EchoPacket> serverEchoRegistrator;
+static loadgen::ClientHandlers::HandlerRegistrator<loadgen::EchoPacket> clientEchoRegistrator;
+
+int main(int argc, char** argv)
+{
+    loadgen::Options options;
+
+    if (!loadgen::ParseOptions(argc, argv, options))
+    {
+        loadgen::PrintUsage();
+        return 1;
+    }
+
+    return loadgen::Run(options);
+}
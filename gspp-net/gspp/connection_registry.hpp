@@ -0,0 +1,540 @@
+//
+//  connection_registry.hpp
+//  gspp-net
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bacs/bacs.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace gspp
+{
+    namespace detail
+    {
+        /// @brief Epoch-based reclamation shared by every registry.
+        /// Readers pin the current epoch while they hold raw pointers, and retired objects are only freed
+        /// once every pinned reader has moved past the epoch they were retired in.
+        class EpochDomain
+        {
+            struct Record
+            {
+                std::atomic<uint64_t> epoch{ 0 };
+                std::atomic<bool> in_use{ true };
+                unsigned depth = 0;
+            };
+
+        public:
+            static EpochDomain& GetInstance()
+            {
+                static EpochDomain instance;
+                return instance;
+            }
+
+            /// @brief Pins the epoch for the current thread. Guards nest.
+            class Guard
+            {
+            public:
+                Guard()
+                    : _record(EpochDomain::GetInstance().Local())
+                {
+                    if (_record.depth++ == 0)
+                    {
+                        _record.epoch.store(EpochDomain::GetInstance()._epoch.load());
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                    }
+                }
+
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+
+                ~Guard()
+                {
+                    if (--_record.depth == 0)
+                        _record.epoch.store(0, std::memory_order_release);
+                }
+
+            private:
+                Record& _record;
+            };
+
+            /// @brief Frees the object once no reader can still see it. Must be called after it has been unlinked.
+            void Retire(std::function<void()> deleter)
+            {
+                std::vector<std::function<void()>> reclaimed;
+
+                {
+                    std::lock_guard lg{ _lock };
+
+                    _retired.push_back({ _epoch.fetch_add(1), std::move(deleter) });
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                    uint64_t oldest = UINT64_MAX;
+
+                    for (auto& record : _records)
+                    {
+                        auto epoch = record->epoch.load();
+
+                        if (epoch != 0)
+                            oldest = std::min(oldest, epoch);
+                    }
+
+                    auto it = std::partition(_retired.begin(), _retired.end(), [oldest](const Retired& retired) { return retired.epoch >= oldest; });
+
+                    for (auto i = it; i != _retired.end(); ++i)
+                        reclaimed.push_back(std::move(i->deleter));
+
+                    _retired.erase(it, _retired.end());
+                }
+
+                // Deleters may destroy connections, which may come back here, so they run unlocked
+                for (auto& deleter : reclaimed)
+                    deleter();
+            }
+
+        private:
+            struct Retired
+            {
+                uint64_t epoch;
+                std::function<void()> deleter;
+            };
+
+            EpochDomain() = default;
+
+            ~EpochDomain()
+            {
+                for (auto& retired : _retired)
+                    retired.deleter();
+            }
+
+            Record& Local()
+            {
+                struct Lease
+                {
+                    Record* record = nullptr;
+
+                    ~Lease()
+                    {
+                        if (record)
+                            record->in_use.store(false, std::memory_order_release);
+                    }
+                };
+
+                thread_local Lease lease;
+
+                if (!lease.record)
+                    lease.record = &Acquire();
+
+                return *lease.record;
+            }
+
+            Record& Acquire()
+            {
+                std::lock_guard lg{ _lock };
+
+                for (auto& record : _records)
+                {
+                    bool expected = false;
+                    if (record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                        return *record;
+                }
+
+                _records.push_back(std::make_unique<Record>());
+                return *_records.back();
+            }
+
+            // Zero marks a thread that isn't reading
+            std::atomic<uint64_t> _epoch{ 1 };
+
+            std::mutex _lock;
+            std::vector<std::unique_ptr<Record>> _records;
+            std::vector<Retired> _retired;
+        };
+    }
+
+    /// @brief Owns a server's connections and hands out their ids.
+    ///
+    /// Ids are generational slot indices: the low 20 bits pick the slot and the high 12 bits count its reuses,
+    /// so a stale id never resolves to a newer connection. Lookups and iteration take no locks; adding and removing
+    /// connections is serialized. Endpoints are mapped to connections through a striped map, so datagram routing
+    /// only ever locks one stripe.
+    /// Connections are constructed by the registry as Connection(id, args...), which fits DualConnection.
+    template<class Connection, class Endpoint = boost::asio::ip::udp::endpoint>
+    class ConnectionRegistry
+    {
+    public:
+        static constexpr unsigned IndexBits = 20;
+        static constexpr uint32_t IndexMask = (uint32_t(1) << IndexBits) - 1;
+        static constexpr uint32_t GenerationMask = UINT32_MAX >> IndexBits;
+        static constexpr std::size_t MaxConnections = std::size_t(1) << IndexBits;
+
+        ConnectionRegistry() = default;
+        ConnectionRegistry(const ConnectionRegistry&) = delete;
+        ConnectionRegistry(ConnectionRegistry&&) = delete;
+
+        /// @brief Nothing may read the registry while it's destroyed.
+        ~ConnectionRegistry()
+        {
+            for (auto& segment : _segments)
+            {
+                auto pointer = segment.load(std::memory_order_relaxed);
+
+                if (!pointer)
+                    continue;
+
+                for (auto& slot : pointer->slots)
+                    delete slot.entry.load(std::memory_order_relaxed);
+
+                delete pointer;
+            }
+        }
+
+        /// @brief Constructs a connection under a fresh id and registers it.
+        template<class... Args>
+        std::shared_ptr<Connection> Emplace(Args&&... args)
+        {
+            std::lock_guard lg{ _writeLock };
+
+            uint32_t index;
+
+            if (!_freeIndices.empty())
+                index = _freeIndices.front();
+            else if (_highWater.load(std::memory_order_relaxed) < MaxConnections)
+                index = _highWater.load(std::memory_order_relaxed);
+            else
+                throw std::runtime_error("gspp::ConnectionRegistry.Emplace: registry is full");
+
+            auto& slot = SlotForWrite(index);
+
+            auto generation = (slot.generation + 1) & GenerationMask;
+            if (generation == 0)
+                generation = 1;
+
+            // Ids are never zero, so zero can keep meaning "no connection"
+            auto id = (generation << IndexBits) | index;
+            auto connection = std::make_shared<Connection>(id, std::forward<Args>(args)...);
+
+            if (!_freeIndices.empty())
+                _freeIndices.pop_front();
+            else
+                _highWater.store(index + 1, std::memory_order_release);
+
+            slot.generation = generation;
+            slot.entry.store(new Entry{ id, connection }, std::memory_order_release);
+
+            _size.fetch_add(1, std::memory_order_relaxed);
+            return connection;
+        }
+
+        /// @brief Unregisters a connection along with its endpoint. Readers that already found it keep their reference.
+        bool Remove(uint32_t id)
+        {
+            std::lock_guard lg{ _writeLock };
+
+            auto slot = SlotFor(id);
+            if (!slot)
+                return false;
+
+            auto entry = slot->entry.load(std::memory_order_relaxed);
+            if (!entry || entry->id != id)
+                return false;
+
+            slot->entry.store(nullptr);
+
+            if (slot->has_endpoint)
+            {
+                auto& stripe = StripeFor(slot->endpoint);
+                std::lock_guard slg{ stripe.lock };
+
+                stripe.ids.erase(slot->endpoint);
+                slot->has_endpoint = false;
+            }
+
+            _freeIndices.push_back(id & IndexMask);
+            _size.fetch_sub(1, std::memory_order_relaxed);
+
+            detail::EpochDomain::GetInstance().Retire([entry] { delete entry; });
+            return true;
+        }
+
+        std::shared_ptr<Connection> Find(uint32_t id) const
+        {
+            auto slot = SlotFor(id);
+            if (!slot)
+                return nullptr;
+
+            detail::EpochDomain::Guard guard;
+
+            auto entry = slot->entry.load();
+            return (entry && entry->id == id) ? entry->connection : nullptr;
+        }
+
+        /// @brief Routes datagrams from the endpoint to the connection, replacing the connection's previous endpoint.
+        /// A connection the endpoint was bound to before loses it.
+        bool BindEndpoint(uint32_t id, const Endpoint& ep)
+        {
+            std::lock_guard lg{ _writeLock };
+
+            auto slot = SlotFor(id);
+            if (!slot)
+                return false;
+
+            auto entry = slot->entry.load(std::memory_order_relaxed);
+            if (!entry || entry->id != id)
+                return false;
+
+            if (slot->has_endpoint)
+            {
+                auto& stripe = StripeFor(slot->endpoint);
+                std::lock_guard slg{ stripe.lock };
+
+                stripe.ids.erase(slot->endpoint);
+            }
+
+            {
+                auto& stripe = StripeFor(ep);
+                std::lock_guard slg{ stripe.lock };
+
+                auto [it, inserted] = stripe.ids.try_emplace(ep, id);
+                if (!inserted && it->second != id)
+                {
+                    // Otherwise removing the previous owner would unbind the endpoint from this connection
+                    if (auto previous = SlotFor(it->second))
+                        previous->has_endpoint = false;
+
+                    it->second = id;
+                }
+            }
+
+            slot->endpoint = ep;
+            slot->has_endpoint = true;
+            return true;
+        }
+
+        std::shared_ptr<Connection> FindByEndpoint(const Endpoint& ep) const
+        {
+            uint32_t id;
+
+            {
+                auto& stripe = StripeFor(ep);
+                std::lock_guard slg{ stripe.lock };
+
+                auto it = stripe.ids.find(ep);
+                if (it == stripe.ids.end())
+                    return nullptr;
+
+                id = it->second;
+            }
+
+            return Find(id);
+        }
+
+        std::size_t size() const
+        {
+            return _size.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Calls the function with every registered connection. Connections added or removed meanwhile may or may not be visited.
+        template<class Function>
+        void ForEach(Function&& function) const
+        {
+            ForEachIn(0, _highWater.load(std::memory_order_acquire), function);
+        }
+
+        /// @brief Splits the connections into chunks and visits them on the context's threads as well as the calling one.
+        /// Returns once every connection has been visited; the first exception thrown by the function is rethrown here.
+        /// @param numWorkers The number of threads running the context, e.g. the size of its io_worker_pool
+        template<class IOContext, class Function>
+        void ParallelForEach(IOContext& context, std::size_t numWorkers, Function&& function) const
+        {
+            // A few chunks per thread keeps them busy when connections are unevenly spread over the slots
+            constexpr std::size_t MinChunkSize = 256;
+            constexpr std::size_t ChunksPerWorker = 4;
+
+            auto end = (std::size_t)_highWater.load(std::memory_order_acquire);
+            auto job = std::make_shared<ParallelJob>();
+
+            job->end = end;
+            job->chunk_size = std::max(MinChunkSize, (end + numWorkers * ChunksPerWorker - 1) / std::max<std::size_t>(numWorkers * ChunksPerWorker, 1));
+            job->chunks = (end + job->chunk_size - 1) / job->chunk_size;
+
+            if (job->chunks <= 1)
+            {
+                ForEach(function);
+                return;
+            }
+
+            // Chunks are claimed by whoever gets to them first. Tasks that start after every chunk is claimed do nothing,
+            // so they never touch the function or the registry after this returns.
+            auto work = [this, job, pFunction = &function]
+            {
+                for (std::size_t chunk; (chunk = job->next.fetch_add(1)) < job->chunks;)
+                {
+                    try
+                    {
+                        auto begin = chunk * job->chunk_size;
+                        ForEachIn(begin, std::min(begin + job->chunk_size, job->end), *pFunction);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard lg{ job->lock };
+
+                        if (!job->error)
+                            job->error = std::current_exception();
+                    }
+
+                    std::lock_guard lg{ job->lock };
+
+                    if (++job->completed == job->chunks)
+                        job->done.notify_all();
+                }
+            };
+
+            for (std::size_t i = 1; i < std::min(numWorkers + 1, job->chunks); i++)
+                boost::asio::post(context, work);
+
+            work();
+
+            std::unique_lock ul{ job->lock };
+            job->done.wait(ul, [&job] { return job->completed == job->chunks; });
+
+            if (job->error)
+                std::rethrow_exception(job->error);
+        }
+
+    private:
+        static constexpr std::size_t SegmentSize = 1024;
+        static constexpr std::size_t NumSegments = MaxConnections / SegmentSize;
+        static constexpr std::size_t NumStripes = 64;
+
+        // Immutable once published, so readers can use it without synchronization while their epoch is pinned
+        struct Entry
+        {
+            uint32_t id;
+            std::shared_ptr<Connection> connection;
+        };
+
+        struct Slot
+        {
+            std::atomic<Entry*> entry{ nullptr };
+
+            // Only touched under the write lock
+            uint32_t generation = 0;
+            bool has_endpoint = false;
+            Endpoint endpoint;
+        };
+
+        // Slots live in fixed segments that are never moved or freed, so readers never see storage go away
+        struct Segment
+        {
+            std::array<Slot, SegmentSize> slots;
+        };
+
+        struct EndpointHash
+        {
+            std::size_t operator()(const Endpoint& ep) const
+            {
+                return std::hash<std::string_view>{}(std::string_view((const char*)ep.data(), ep.size()));
+            }
+        };
+
+        struct alignas(64) EndpointStripe
+        {
+            mutable std::mutex lock;
+            std::unordered_map<Endpoint, uint32_t, EndpointHash> ids;
+        };
+
+        struct ParallelJob
+        {
+            std::atomic<std::size_t> next{ 0 };
+            std::size_t end = 0;
+            std::size_t chunk_size = 0;
+            std::size_t chunks = 0;
+
+            std::mutex lock;
+            std::condition_variable done;
+            std::size_t completed = 0;
+            std::exception_ptr error;
+        };
+
+        const Slot* SlotFor(uint32_t id) const
+        {
+            auto index = id & IndexMask;
+            auto segment = _segments[index / SegmentSize].load(std::memory_order_acquire);
+
+            return segment ? &segment->slots[index % SegmentSize] : nullptr;
+        }
+
+        Slot* SlotFor(uint32_t id)
+        {
+            return const_cast<Slot*>(static_cast<const ConnectionRegistry*>(this)->SlotFor(id));
+        }
+
+        Slot& SlotForWrite(uint32_t index)
+        {
+            auto& segment = _segments[index / SegmentSize];
+            auto pointer = segment.load(std::memory_order_relaxed);
+
+            if (!pointer)
+            {
+                pointer = new Segment();
+                segment.store(pointer, std::memory_order_release);
+            }
+
+            return pointer->slots[index % SegmentSize];
+        }
+
+        EndpointStripe& StripeFor(const Endpoint& ep) const
+        {
+            return _stripes[EndpointHash{}(ep) % NumStripes];
+        }
+
+        template<class Function>
+        void ForEachIn(std::size_t begin, std::size_t end, Function& function) const
+        {
+            detail::EpochDomain::Guard guard;
+
+            for (auto segmentIndex = begin / SegmentSize; segmentIndex * SegmentSize < end; segmentIndex++)
+            {
+                auto segment = _segments[segmentIndex].load(std::memory_order_acquire);
+                if (!segment)
+                    continue;
+
+                auto first = std::max(begin, segmentIndex * SegmentSize);
+                auto last = std::min(end, (segmentIndex + 1) * SegmentSize);
+
+                for (auto index = first; index < last; index++)
+                {
+                    auto entry = segment->slots[index % SegmentSize].entry.load();
+
+                    if (entry)
+                        function(*entry->connection);
+                }
+            }
+        }
+
+        std::array<std::atomic<Segment*>, NumSegments> _segments{};
+        std::atomic<uint32_t> _highWater{ 0 };
+        std::atomic<std::size_t> _size{ 0 };
+
+        std::mutex _writeLock;
+        std::deque<uint32_t> _freeIndices;
+
+        mutable std::array<EndpointStripe, NumStripes> _stripes;
+    };
+}
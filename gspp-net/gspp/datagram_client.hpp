@@ -19,11 +19,11 @@
 
 namespace gspp
 {
-	template<class Protocol, class SPTraits = bacs::sp_default, size_t RecvSize = 0xFFFF>
+	template<class Protocol, class SPTraits = bacs::sp_default, size_t RecvSize = 0xFFFF, class ConnectionType = DatagramConnection<Protocol, SPTraits, RecvSize>>
 	class DatagramClient
 	{
 	public:
-		using Connection = DatagramConnection<Protocol, SPTraits, RecvSize>;
+		using Connection = ConnectionType;
 		using Endpoint = typename Connection::Endpoint;
 
 		DatagramClient(std::shared_ptr<Connection> connection, Endpoint ep)
@@ -46,6 +46,12 @@ namespace gspp
 			_conn->Send(_ep, packet);
 		}
 
+		template<class Packet>
+		void Enqueue(const Packet& packet)
+		{
+			_conn->Enqueue(_ep, packet);
+		}
+
 	private:
 		std::shared_ptr<Connection> _conn;
 		Endpoint _ep;
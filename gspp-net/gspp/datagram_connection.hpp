@@ -9,12 +9,30 @@
 #pragma once
 #include <bacs/bacs.hpp>
 #include <plakpacs/plakpacs.hpp>
+#include <array>
 #include <functional>
 #include <queue>
 #include <mutex>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
 #include <boost/asio.hpp>
 
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <cerrno>
+#endif
+
+#include "metrics.hpp"
 #include "packet_serializer.hpp"
+#include "prepared_packet.hpp"
+#include "network_impairment.hpp"
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
 
 namespace gspp
 {
@@ -25,18 +43,15 @@ namespace gspp
         using Socket = typename Protocol::socket;
         using Endpoint = typename Protocol::endpoint;
         using RecvBuffer = std::array<uint8_t, RecvSize>;
+        using Handler = bacs::unique_function<void(Endpoint, bacs::shared_buffer, std::size_t)>;
 
-        DatagramConnection(Socket&& sock, std::function<void(Endpoint, const std::vector<uint8_t>&, std::size_t)> onHandle = {})
-            : _state(std::make_shared<SharedStateBlock>(std::move(sock)))
+        /// @param onHandle Receives each datagram in its own pooled buffer. The handler may keep the buffer for as long as it likes.
+        /// @param numReceives The number of receives kept in flight, which bounds how many handlers can run at once.
+        DatagramConnection(Socket&& sock, Handler onHandle = {}, std::size_t numReceives = 1)
+            : _state(std::make_shared<SharedStateBlock>(std::move(sock), std::move(onHandle), numReceives))
         {
-            auto state = _state;
-            state->RecvLoopAsync(
-                [state, onHandle](const boost::system::error_code& error, std::size_t bytes_transferred, Endpoint ep)
-                {
-                    if (!error.failed())
-                        onHandle(ep, state->recv_buffer, bytes_transferred);
-                }
-            );
+            for (std::size_t i = 0; i < _state->receive_slots.size(); i++)
+                _state->ReceiveAsync(i);
         }
 
         DatagramConnection() = delete;
@@ -45,9 +60,78 @@ namespace gspp
 
         template<class Packet>
         void Send(Endpoint ep, const Packet& packet)
+        {
+            Send(ep, PreparedPacket::Make(packet));
+        }
+
+        /// @brief Sends an already serialized packet. The size prefix is gathered in front of its bytes, which aren't copied.
+        void Send(Endpoint ep, const PreparedPacket& packet)
+        {
+            _state->SendAsync(ep, packet);
+        }
+
+        /// @brief Serializes the packet and appends it to the send batch. Nothing is sent until Flush() is called.
+        template<class Packet>
+        void Enqueue(Endpoint ep, const Packet& packet)
         {
             auto ws = PacketSerializer<Packet>::template Serialize<plakpacs::write_stream>(packet);
-            _state->SendAsync({ ep, ws.bytes() });
+            EnqueueBytes(ep, ws.bytes().data(), ws.bytes().size());
+        }
+
+        void Enqueue(Endpoint ep, const PreparedPacket& packet)
+        {
+            EnqueueBytes(ep, packet.data(), packet.size());
+        }
+
+        /// @brief Appends already serialized packet bytes to the send batch. The bytes are copied into the batch arena.
+        void EnqueueBytes(Endpoint ep, const uint8_t* data, std::size_t size)
+        {
+            _state->Enqueue(ep, data, size);
+        }
+
+        /// @brief Sends everything queued since the last flush, using sendmmsg (and UDP GSO where possible) on Linux.
+        /// Never blocks: whatever a full socket buffer can't take is kept, in order and up to the blocked limit, and sent once the socket is writable again.
+        /// @return The number of datagrams flushed
+        std::size_t Flush()
+        {
+            return _state->Flush();
+        }
+
+        /// @brief Serializes the packet once and sends it to every endpoint in the range as a single batch.
+        template<class EndpointRange, class Packet>
+        std::size_t SendBatch(const EndpointRange& endpoints, const Packet& packet)
+        {
+            return SendBatch(endpoints, PreparedPacket::Make(packet));
+        }
+
+        template<class EndpointRange>
+        std::size_t SendBatch(const EndpointRange& endpoints, const PreparedPacket& packet)
+        {
+            for (auto& ep : endpoints)
+                EnqueueBytes(ep, packet.data(), packet.size());
+
+            return Flush();
+        }
+
+        /// @brief Routes sends and/or receives through simulated network links. Meant for testing; set it up before any traffic flows.
+        void SetImpairment(std::shared_ptr<NetworkImpairment> outgoing, std::shared_ptr<NetworkImpairment> incoming = nullptr)
+        {
+            _state->outgoing_impairment = std::move(outgoing);
+            _state->incoming_impairment = std::move(incoming);
+        }
+
+        /// @brief Bounds the bytes held back while the socket's buffer is full. Past it the oldest datagrams are dropped,
+        /// the way a full queue on the path would drop them.
+        void SetBlockedLimit(std::size_t bytes)
+        {
+            std::lock_guard flg{ _state->flush_lock };
+            _state->blocked_limit = bytes;
+        }
+
+        /// @return The number of datagrams dropped for being held back past the blocked limit
+        uint64_t dropped_datagrams() const
+        {
+            return _state->dropped_datagrams;
         }
 
         ~DatagramConnection()
@@ -56,63 +140,525 @@ namespace gspp
         }
 
     private:
+        // Each send in flight holds its operation and its size prefix
+        static constexpr std::size_t SendHandlerBlocks = 8;
+        static constexpr std::size_t DefaultBlockedLimit = 4 << 20;
+
         struct SharedStateBlock : std::enable_shared_from_this<SharedStateBlock>
         {
             Socket socket;
 
-            struct PendingSendOp
+            // Datagrams are packed back to back into one arena so a flush needs no per-datagram allocations.
+            // Two batches are swapped on flush to let producers keep enqueueing while the kernel is busy.
+            struct Batch
             {
-                Endpoint ep;
+                struct Entry
+                {
+                    Endpoint ep;
+                    std::size_t offset;
+                    std::size_t size;
+                };
+
                 std::vector<uint8_t> bytes;
+                std::vector<Entry> entries;
+
+                void clear()
+                {
+                    bytes.clear();
+                    entries.clear();
+                }
+            };
+
+            // Every outstanding receive owns its endpoint and a buffer from the pool until it completes
+            struct ReceiveSlot
+            {
+                Endpoint ep;
+                bacs::shared_buffer buffer;
+            };
+
+            Handler on_handle;
+            std::shared_ptr<NetworkImpairment> outgoing_impairment;
+            std::shared_ptr<NetworkImpairment> incoming_impairment;
+
+            bacs::buffer_pool recv_pool{ RecvSize };
+            std::vector<ReceiveSlot> receive_slots;
+
+            // One block per receive plus headroom for sends in flight; anything beyond that falls back to the global heap
+            bacs::handler_memory::pointer handler_memory;
+
+            std::mutex batch_lock;
+            Batch pending_batch;
+
+            std::mutex flush_lock;
+            Batch flushing_batch;
+
+            // What a full send buffer held back, and its copy being resent once the socket is writable.
+            // The blocked batch is only non-empty while a wait for writability is armed.
+            Batch blocked_batch;
+            Batch retry_batch;
+            bool waiting_for_write = false;
+            std::size_t blocked_limit = DefaultBlockedLimit;
+            std::atomic<uint64_t> dropped_datagrams{ 0 };
+
+#if defined(__linux__)
+            // The kernel caps GSO at 64 segments per send and one IP datagram worth of payload
+            static constexpr std::size_t MaxGsoSegments = 64;
+            static constexpr std::size_t MaxGsoBytes = 0xFFFF - 8 - 40;
+            static constexpr std::size_t MaxMessagesPerCall = 1024;
+            // Segments are only grouped when each one fits a link of this MTU on its own; bigger ones would be fragmented
+            static constexpr std::size_t PathMtu = 1500;
+
+            struct GsoControl
+            {
+                alignas(cmsghdr) char data[CMSG_SPACE(sizeof(uint16_t))];
             };
 
-            std::vector<uint8_t> recv_buffer;
+            std::vector<mmsghdr> mmsg_scratch;
+            std::vector<iovec> iov_scratch;
+            std::vector<GsoControl> control_scratch;
+            std::vector<std::size_t> group_scratch;
+            // UDP_SEGMENT means nothing to other datagram protocols, which would send each group as one datagram
+            std::atomic<bool> gso_enabled = std::is_same_v<Protocol, boost::asio::ip::udp>;
+            std::size_t max_gso_segment = PathMtu - 40 - 8;
+#endif
+
+            SharedStateBlock(Socket&& rvsocket, Handler onHandle, std::size_t numReceives)
+                : socket(std::move(rvsocket)), on_handle(std::move(onHandle)), receive_slots(std::max<std::size_t>(numReceives, 1)),
+                  handler_memory(bacs::handler_memory::create(receive_slots.size() + SendHandlerBlocks))
+            {
+                // Batched sends go around asio, and must return instead of waiting when the socket's buffer is full
+                boost::system::error_code ec;
+                socket.non_blocking(true, ec);
+
+#if defined(__linux__)
+                ProbeGso();
+#endif
+            }
 
-            SharedStateBlock(Socket&& rvsocket)
-                : socket(std::move(rvsocket))
+            bacs::handler_allocator<> handler_allocator() const
             {
-                recv_buffer.resize(RecvSize);
+                return bacs::handler_allocator<>(*handler_memory);
             }
 
-            template<class F>
-            void RecvLoopAsync(F&& handler)
+            void ReceiveAsync(std::size_t index)
             {
                 auto state = this->shared_from_this();
-                auto ep = std::make_shared<Endpoint>();
 
-                state->socket.async_receive_from(
-                    boost::asio::buffer(recv_buffer.data(), recv_buffer.size()),
-                    *ep, 0,
-                    [state, ep, handler](const boost::system::error_code& error, std::size_t bytes_transferred)
+                auto& slot = receive_slots[index];
+                slot.buffer = recv_pool.acquire();
+
+                socket.async_receive_from(
+                    boost::asio::buffer(slot.buffer.data(), slot.buffer.size()),
+                    slot.ep, 0,
+                    bacs::bind_allocator(handler_allocator(),
+                    [state, index](const boost::system::error_code& error, std::size_t bytes_transferred)
                     {
-                        handler(error, bytes_transferred, *ep);
-                        state->RecvLoopAsync(handler);
-                    }
+                        if (error == boost::asio::error::operation_aborted || error == boost::asio::error::bad_descriptor)
+                            return;
+
+                        auto& slot = state->receive_slots[index];
+                        auto buffer = std::move(slot.buffer);
+                        auto ep = slot.ep;
+
+                        // Re-arm before handling so another worker thread can take the next datagram in the meantime
+                        state->ReceiveAsync(index);
+
+                        if (error.failed())
+                            return;
+
+                        GSPP_METRIC_TRAFFIC(Datagram, In, bytes_transferred);
+
+                        if (!state->on_handle)
+                            return;
+
+                        if (state->incoming_impairment)
+                        {
+                            state->incoming_impairment->Submit(bytes_transferred,
+                                [state, ep, buffer, bytes_transferred]
+                                {
+                                    state->on_handle(ep, buffer, bytes_transferred);
+                                });
+                        }
+                        else
+                        {
+                            state->on_handle(ep, std::move(buffer), bytes_transferred);
+                        }
+                    })
                 );
             }
 
-            void SendAsync(const PendingSendOp& data)
+            void SendAsync(const Endpoint& ep, const PreparedPacket& packet)
             {
+                using size_type = typename SPTraits::size_type;
+                auto size = std::allocate_shared<size_type>(handler_allocator(), (size_type)packet.size());
+                SPTraits::out(*size);
+
+                if (outgoing_impairment)
+                {
+                    auto ws = std::make_shared<plakpacs::write_stream>();
+                    ws->write(*size);
+                    ws->write(packet.data(), packet.data() + packet.size());
+
+                    SendFramedAsync(ep, ws);
+                    return;
+                }
+
                 // Same deal as in the ctor
                 auto state = this->shared_from_this();
-                auto ep = data.ep;
 
-                using size_type = typename SPTraits::size_type;
-                auto size = (size_type)data.bytes.size();
-                SPTraits::out(size);
+                std::array<boost::asio::const_buffer, 2> buffers
+                {
+                    boost::asio::const_buffer(size.get(), sizeof(size_type)),
+                    boost::asio::const_buffer(packet.data(), packet.size())
+                };
 
-                auto ws = std::make_shared<plakpacs::write_stream>();
-                ws->write(size);
-                ws->write(data.bytes.begin(), data.bytes.end());
+                socket.async_send_to(
+                    buffers,
+                    ep,
+                    bacs::bind_allocator(handler_allocator(),
+                    [state, size, packet](const boost::system::error_code& ec, std::size_t bytes_sent)
+                    {
+                        if (!ec.failed())
+                            GSPP_METRIC_TRAFFIC(Datagram, Out, bytes_sent);
+                    })
+                );
+            }
+
+            void SendFramedAsync(const Endpoint& ep, std::shared_ptr<plakpacs::write_stream> ws)
+            {
+                auto state = this->shared_from_this();
+
+                if (outgoing_impairment)
+                {
+                    outgoing_impairment->Submit(ws->bytes().size(),
+                        [state, ep, ws]
+                        {
+                            state->SendFramedNow(ep, ws);
+                        });
+                }
+                else
+                {
+                    SendFramedNow(ep, std::move(ws));
+                }
+            }
+
+            void SendFramedNow(const Endpoint& ep, std::shared_ptr<plakpacs::write_stream> ws)
+            {
+                auto state = this->shared_from_this();
+                auto buffer = boost::asio::const_buffer(ws->bytes().data(), ws->bytes().size());
 
-                state->socket.async_send_to(
-                    boost::asio::const_buffer(ws->bytes().data(), ws->bytes().size()),
+                socket.async_send_to(
+                    buffer,
                     ep,
-                    [state, ws](const boost::system::error_code&, std::size_t)
+                    [state, ws](const boost::system::error_code& ec, std::size_t bytes_sent)
                     {
+                        if (!ec.failed())
+                            GSPP_METRIC_TRAFFIC(Datagram, Out, bytes_sent);
                     }
                 );
             }
+
+            void Enqueue(const Endpoint& ep, const uint8_t* data, std::size_t bytes)
+            {
+                using size_type = typename SPTraits::size_type;
+                auto size = (size_type)bytes;
+                SPTraits::out(size);
+
+                std::lock_guard lg{ batch_lock };
+
+                auto& batch = pending_batch;
+                auto offset = batch.bytes.size();
+
+                batch.bytes.resize(offset + sizeof(size) + bytes);
+                std::memcpy(batch.bytes.data() + offset, &size, sizeof(size));
+                std::memcpy(batch.bytes.data() + offset + sizeof(size), data, bytes);
+
+                batch.entries.push_back({ ep, offset, sizeof(size) + bytes });
+            }
+
+            std::size_t Flush()
+            {
+                std::lock_guard flg{ flush_lock };
+
+                {
+                    std::lock_guard blg{ batch_lock };
+                    std::swap(pending_batch, flushing_batch);
+                }
+
+                auto count = flushing_batch.entries.size();
+
+                if (count && outgoing_impairment)
+                {
+                    // The simulated link delays every datagram on its own, so the batch can't go out in one call
+                    for (auto& entry : flushing_batch.entries)
+                    {
+                        auto ws = std::make_shared<plakpacs::write_stream>();
+                        auto begin = flushing_batch.bytes.begin() + entry.offset;
+                        ws->write(begin, begin + entry.size);
+
+                        SendFramedAsync(entry.ep, ws);
+                    }
+                }
+                else if (count && waiting_for_write)
+                {
+                    // Queue up behind what's already waiting, so datagrams don't overtake each other
+                    Block(flushing_batch, 0);
+                }
+                else if (count)
+                {
+                    SendOrBlock(flushing_batch);
+                }
+
+                flushing_batch.clear();
+                return count;
+            }
+
+            // Expects flush_lock to be held
+            void SendOrBlock(const Batch& batch)
+            {
+                auto first = SendBatch(batch, 0);
+                if (first == batch.entries.size())
+                    return;
+
+                Block(batch, first);
+                waiting_for_write = true;
+
+                auto state = this->shared_from_this();
+                socket.async_wait(Socket::wait_write,
+                    [state](const boost::system::error_code& ec)
+                    {
+                        std::lock_guard flg{ state->flush_lock };
+                        state->waiting_for_write = false;
+
+                        if (ec == boost::asio::error::operation_aborted || ec == boost::asio::error::bad_descriptor)
+                        {
+                            state->blocked_batch.clear();
+                            return;
+                        }
+
+                        std::swap(state->blocked_batch, state->retry_batch);
+                        state->SendOrBlock(state->retry_batch);
+                        state->retry_batch.clear();
+                    });
+            }
+
+            // Expects flush_lock to be held
+            void Block(const Batch& batch, std::size_t first)
+            {
+                AppendEntries(blocked_batch, batch, first);
+
+                auto& bytes = blocked_batch.bytes;
+                auto& entries = blocked_batch.entries;
+
+                if (bytes.size() <= blocked_limit)
+                    return;
+
+                // The blocked batch is packed from its start, so dropping the oldest entries up to here frees enough
+                auto excess = bytes.size() - blocked_limit;
+                std::size_t drop = 0;
+
+                while (drop < entries.size() && entries[drop].offset < excess)
+                    drop++;
+
+                dropped_datagrams += drop;
+
+                if (drop == entries.size())
+                {
+                    blocked_batch.clear();
+                    return;
+                }
+
+                auto begin = entries[drop].offset;
+                bytes.erase(bytes.begin(), bytes.begin() + begin);
+                entries.erase(entries.begin(), entries.begin() + drop);
+
+                for (auto& entry : entries)
+                    entry.offset -= begin;
+            }
+
+            static void AppendEntries(Batch& to, const Batch& from, std::size_t first)
+            {
+                if (first == from.entries.size())
+                    return;
+
+                // Entries are packed back to back, so everything from the first one on is one run of bytes
+                auto begin = from.entries[first].offset;
+                auto offset = to.bytes.size();
+                to.bytes.insert(to.bytes.end(), from.bytes.begin() + begin, from.bytes.end());
+
+                for (auto i = first; i < from.entries.size(); i++)
+                {
+                    auto entry = from.entries[i];
+                    entry.offset = entry.offset - begin + offset;
+                    to.entries.push_back(entry);
+                }
+            }
+
+#if defined(__linux__)
+            // Kernels without UDP GSO refuse the option outright, so one setsockopt tells whether to bother
+            void ProbeGso()
+            {
+                if constexpr (std::is_same_v<Protocol, boost::asio::ip::udp>)
+                {
+                    int segment = 0;
+                    if (::setsockopt(socket.native_handle(), SOL_UDP, UDP_SEGMENT, &segment, sizeof(segment)) != 0)
+                    {
+                        gso_enabled = false;
+                        return;
+                    }
+
+                    boost::system::error_code ec;
+                    if (socket.local_endpoint(ec).protocol() == boost::asio::ip::udp::v4())
+                        max_gso_segment = PathMtu - 20 - 8;
+                }
+            }
+
+            /// @return The first entry the socket had no room for, or the end of the batch
+            std::size_t SendBatch(const Batch& batch, std::size_t first)
+            {
+                auto& entries = batch.entries;
+                bool gso = gso_enabled;
+
+                // Split the batch into groups: consecutive datagrams to one endpoint that GSO can send as one buffer.
+                // Every segment but the last must have the size of the first one.
+                auto& groups = group_scratch;
+                groups.clear();
+
+                for (std::size_t i = first; i < entries.size();)
+                {
+                    std::size_t end = i + 1;
+
+                    if (gso && entries[i].size <= max_gso_segment)
+                    {
+                        auto segment = entries[i].size;
+                        auto total = segment;
+
+                        while (end < entries.size() && end - i < MaxGsoSegments &&
+                               entries[end].ep == entries[i].ep && entries[end].size <= segment &&
+                               entries[end - 1].size == segment && total + entries[end].size <= MaxGsoBytes)
+                        {
+                            total += entries[end].size;
+                            end++;
+                        }
+                    }
+
+                    groups.push_back(i);
+                    i = end;
+                }
+
+                groups.push_back(entries.size());
+
+                auto num_groups = groups.size() - 1;
+                mmsg_scratch.resize(num_groups);
+                iov_scratch.resize(num_groups);
+                control_scratch.resize(num_groups);
+
+                for (std::size_t g = 0; g < num_groups; g++)
+                {
+                    auto& first = entries[groups[g]];
+                    auto& last = entries[groups[g + 1] - 1];
+                    auto segments = groups[g + 1] - groups[g];
+
+                    auto& iov = iov_scratch[g];
+                    iov.iov_base = (void*)(batch.bytes.data() + first.offset);
+                    iov.iov_len = last.offset + last.size - first.offset;
+
+                    auto& msg = mmsg_scratch[g];
+                    msg = {};
+                    msg.msg_hdr.msg_name = (void*)first.ep.data();
+                    msg.msg_hdr.msg_namelen = (socklen_t)first.ep.size();
+                    msg.msg_hdr.msg_iov = &iov;
+                    msg.msg_hdr.msg_iovlen = 1;
+
+                    if (segments > 1)
+                    {
+                        auto& control = control_scratch[g];
+                        msg.msg_hdr.msg_control = control.data;
+                        msg.msg_hdr.msg_controllen = sizeof(control.data);
+
+                        auto cmsg = CMSG_FIRSTHDR(&msg.msg_hdr);
+                        cmsg->cmsg_level = SOL_UDP;
+                        cmsg->cmsg_type = UDP_SEGMENT;
+                        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+                        auto segment_size = (uint16_t)first.size;
+                        std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+                    }
+                }
+
+                auto fd = socket.native_handle();
+
+                for (std::size_t sent = 0; sent < num_groups;)
+                {
+                    auto chunk = (unsigned int)std::min(num_groups - sent, MaxMessagesPerCall);
+                    auto result = ::sendmmsg(fd, mmsg_scratch.data() + sent, chunk, 0);
+
+                    if (result > 0)
+                    {
+                        for (auto i = groups[sent]; i < groups[sent + result]; i++)
+                            GSPP_METRIC_TRAFFIC(Datagram, Out, entries[i].size);
+
+                        sent += result;
+                        continue;
+                    }
+
+                    if (result < 0 && errno == EINTR)
+                        continue;
+
+                    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                        return groups[sent];
+
+                    // The kernel doesn't know UDP_SEGMENT at all; stop using GSO and resend the rest one by one
+                    if (result < 0 && gso && errno == ENOPROTOOPT)
+                    {
+                        gso_enabled = false;
+                        return SendBatch(batch, groups[sent]);
+                    }
+
+                    // A route or NIC that can't segment this one group says so with EIO or EINVAL; it goes out unsegmented
+                    if (result < 0 && groups[sent + 1] - groups[sent] > 1 && (errno == EIO || errno == EINVAL))
+                    {
+                        auto unsent = SendEach(batch, groups[sent], groups[sent + 1]);
+                        if (unsent != groups[sent + 1])
+                            return unsent;
+
+                        sent++;
+                        continue;
+                    }
+
+                    // Anything else is about the first datagram alone, e.g. an unreachable peer; drop it like the network would
+                    sent++;
+                }
+
+                return entries.size();
+            }
+#else
+            /// @return The first entry the socket had no room for, or the end of the batch
+            std::size_t SendBatch(const Batch& batch, std::size_t first)
+            {
+                return SendEach(batch, first, batch.entries.size());
+            }
+#endif
+
+            /// @return The first entry in [first, last) the socket had no room for, or last
+            std::size_t SendEach(const Batch& batch, std::size_t first, std::size_t last)
+            {
+                for (auto i = first; i < last; i++)
+                {
+                    auto& entry = batch.entries[i];
+
+                    boost::system::error_code ec;
+                    socket.send_to(boost::asio::const_buffer(batch.bytes.data() + entry.offset, entry.size), entry.ep, 0, ec);
+
+                    if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again)
+                        return i;
+
+                    if (!ec.failed())
+                        GSPP_METRIC_TRAFFIC(Datagram, Out, entry.size);
+                }
+
+                return last;
+            }
         };
 
         std::shared_ptr<SharedStateBlock> _state;
@@ -15,6 +15,7 @@
 #include <boost/asio.hpp>
 
 #include "packet_serializer.hpp"
+#include "prepared_packet.hpp"
 
 #include "componentable.hpp"
 
@@ -43,14 +44,14 @@ namespace gspp
 		template<class HandlerSystem>
 		void SetupStreamClient(
 			typename StreamClient::Socket&& socket,
-			std::function<void(DualConnection&, typename HandlerSystem::HandlerResult)> onHandle = {},
-			std::function<void(DualConnection&, const boost::system::error_code& ec)> onDeath = {},
-			std::function<void(DualConnection&, const std::exception& e)> onHandleException = {})
+			bacs::unique_function<void(DualConnection&, typename HandlerSystem::HandlerResult)> onHandle = {},
+			bacs::unique_function<void(DualConnection&, const boost::system::error_code& ec)> onDeath = {},
+			bacs::unique_function<void(DualConnection&, const std::exception& e)> onHandleException = {})
 		{
 			_streamClient =
 				std::make_shared<StreamClient>(
 					std::move(socket),
-					[this, onHandle, onHandleException](bacs::shared_buffer& buffer)
+					[this, onHandle = std::move(onHandle), onHandleException = std::move(onHandleException)](bacs::shared_buffer& buffer)
 					{
 						try
 						{
@@ -82,7 +83,7 @@ namespace gspp
 							return false;
 						}
 					},
-					[this, onDeath](const boost::system::error_code& ec)
+					[this, onDeath = std::move(onDeath)](const boost::system::error_code& ec)
 					{
 						if (onDeath)
 							onDeath(*this, ec);
@@ -106,6 +107,25 @@ namespace gspp
 			_killed = true;
 		}
 
+		/// @brief Queues an already serialized packet on the stream client, so Broadcast() can fan it out over connections.
+		bool Send(const PreparedPacket& packet)
+		{
+			if (!_streamClient)
+				return false;
+
+			return _streamClient->Send(packet);
+		}
+
+		/// @brief Sends an already serialized packet over the datagram client.
+		bool SendDG(const PreparedPacket& packet)
+		{
+			if (!_dgClient)
+				return false;
+
+			_dgClient->Send(packet);
+			return true;
+		}
+
 		void Close()
 		{
 			if (_streamClient)
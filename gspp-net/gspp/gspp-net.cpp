@@ -6,9 +6,15 @@
 //
 
 #include "componentable.hpp"
+#include "connection_registry.hpp"
 #include "datagram_client.hpp"
 #include "datagram_connection.hpp"
 #include "dual_connection.hpp"
+#include "metrics.hpp"
+#include "network_impairment.hpp"
 #include "packet_handlers.hpp"
 #include "packet_serializer.hpp"
+#include "prepared_packet.hpp"
+#include "reliable_client.hpp"
+#include "sharded_datagram_connection.hpp"
 #include "stream_client.hpp"
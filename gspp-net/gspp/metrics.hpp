@@ -0,0 +1,382 @@
+//
+//  metrics.hpp
+//  gspp-net
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(GSPP_ENABLE_METRICS) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define GSPP_METRICS_HAS_TSC
+#endif
+
+// Hot-path instrumentation for gspp connections. Define GSPP_ENABLE_METRICS to turn it on;
+// otherwise every GSPP_METRIC_* macro expands to nothing and Collect() returns an empty snapshot.
+
+namespace gspp
+{
+    namespace metrics
+    {
+        enum class Transport : std::size_t
+        {
+            Stream,
+            Datagram,
+            Reliable,
+            Count
+        };
+
+        enum class Direction : std::size_t
+        {
+            In,
+            Out,
+            Count
+        };
+
+        constexpr std::size_t TransportCount = (std::size_t)Transport::Count;
+        constexpr std::size_t DirectionCount = (std::size_t)Direction::Count;
+
+        /// @brief Handler counts are kept per packet id for integral ids below this. Larger ids and ids of other types
+        /// are only counted in total, as handled_other.
+        constexpr std::size_t PacketIdSlots = 1024;
+
+        /// @brief Latency histograms use power-of-two buckets of timestamp ticks.
+        constexpr std::size_t HistogramBuckets = 48;
+
+        struct Histogram
+        {
+            std::array<uint64_t, HistogramBuckets> buckets{};
+            uint64_t count = 0;
+
+            /// @brief An upper bound of the given percentile in nanoseconds, to within a factor of two.
+            double Percentile(double p, double ticksPerNanosecond) const
+            {
+                if (count == 0)
+                    return 0.0;
+
+                auto target = (uint64_t)(p * count);
+                uint64_t seen = 0;
+
+                for (std::size_t i = 0; i < HistogramBuckets; i++)
+                {
+                    seen += buckets[i];
+
+                    if (seen > target)
+                        return (double)(uint64_t(1) << i) / ticksPerNanosecond;
+                }
+
+                return (double)(uint64_t(1) << (HistogramBuckets - 1)) / ticksPerNanosecond;
+            }
+        };
+
+        struct Snapshot
+        {
+            struct TransportCounters
+            {
+                uint64_t bytes_in = 0;
+                uint64_t bytes_out = 0;
+                uint64_t packets_in = 0;
+                uint64_t packets_out = 0;
+            };
+
+            bool enabled = false;
+            std::array<TransportCounters, TransportCount> transports{};
+
+            /// @brief (packet id, handled count) for every id below PacketIdSlots that has been handled.
+            std::vector<std::pair<std::size_t, uint64_t>> handled_packets;
+
+            /// @brief How many packets were handled with an id that has no slot of its own.
+            uint64_t handled_other = 0;
+
+            Histogram handler_latency;
+            double ticks_per_nanosecond = 1.0;
+
+            const TransportCounters& operator[](Transport transport) const
+            {
+                return transports[(std::size_t)transport];
+            }
+        };
+
+        /// @brief Per-connection write queue gauges.
+        struct QueueMetrics
+        {
+            uint64_t depth = 0;
+            uint64_t high_water = 0;
+        };
+
+#if defined(GSPP_ENABLE_METRICS)
+        inline uint64_t Timestamp()
+        {
+#if defined(GSPP_METRICS_HAS_TSC)
+            return __rdtsc();
+#else
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        namespace detail
+        {
+            // Only the owning thread writes to these, so a relaxed load + store is enough and avoids locked instructions
+            inline void Bump(std::atomic<uint64_t>& counter, uint64_t amount = 1)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            inline std::size_t Log2(uint64_t value)
+            {
+                std::size_t bucket = 0;
+
+                while (value >>= 1)
+                    bucket++;
+
+                return std::min(bucket, HistogramBuckets - 1);
+            }
+
+            template<class IdType>
+            bool IdSlot(const IdType& id, std::size_t& slot)
+            {
+                if constexpr (std::is_enum_v<IdType>)
+                {
+                    return IdSlot(static_cast<std::underlying_type_t<IdType>>(id), slot);
+                }
+                else if constexpr (std::is_integral_v<IdType>)
+                {
+                    if constexpr (std::is_signed_v<IdType>)
+                        if (id < 0)
+                            return false;
+
+                    if ((std::make_unsigned_t<IdType>)id >= PacketIdSlots)
+                        return false;
+
+                    slot = (std::size_t)id;
+                    return true;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            struct ThreadCounters
+            {
+                std::atomic<bool> in_use{ true };
+
+                std::array<std::atomic<uint64_t>, TransportCount * DirectionCount> bytes{};
+                std::array<std::atomic<uint64_t>, TransportCount * DirectionCount> packets{};
+                std::array<std::atomic<uint64_t>, PacketIdSlots> handled{};
+                std::atomic<uint64_t> handled_other{ 0 };
+                std::array<std::atomic<uint64_t>, HistogramBuckets> handler_latency{};
+            };
+        }
+
+        /// @brief Owns the per-thread counter blocks and sums them up on demand.
+        /// Blocks of exited threads are handed to new threads instead of being freed, so totals never go backwards.
+        class Registry
+        {
+        public:
+            static Registry& GetInstance()
+            {
+                static Registry instance;
+                return instance;
+            }
+
+            detail::ThreadCounters& Local()
+            {
+                struct Lease
+                {
+                    detail::ThreadCounters* block = nullptr;
+
+                    ~Lease()
+                    {
+                        if (block)
+                            block->in_use.store(false, std::memory_order_release);
+                    }
+                };
+
+                thread_local Lease lease;
+
+                if (!lease.block)
+                    lease.block = &Acquire();
+
+                return *lease.block;
+            }
+
+            Snapshot Collect()
+            {
+                Snapshot snapshot;
+                snapshot.enabled = true;
+                snapshot.ticks_per_nanosecond = TicksPerNanosecond();
+
+                std::array<uint64_t, PacketIdSlots> handled{};
+
+                std::lock_guard lg{ _lock };
+
+                for (auto& block : _blocks)
+                {
+                    for (std::size_t t = 0; t < TransportCount; t++)
+                    {
+                        auto& counters = snapshot.transports[t];
+                        auto in = t * DirectionCount + (std::size_t)Direction::In;
+                        auto out = t * DirectionCount + (std::size_t)Direction::Out;
+
+                        counters.bytes_in += block->bytes[in].load(std::memory_order_relaxed);
+                        counters.bytes_out += block->bytes[out].load(std::memory_order_relaxed);
+                        counters.packets_in += block->packets[in].load(std::memory_order_relaxed);
+                        counters.packets_out += block->packets[out].load(std::memory_order_relaxed);
+                    }
+
+                    for (std::size_t i = 0; i < PacketIdSlots; i++)
+                        handled[i] += block->handled[i].load(std::memory_order_relaxed);
+
+                    snapshot.handled_other += block->handled_other.load(std::memory_order_relaxed);
+
+                    for (std::size_t i = 0; i < HistogramBuckets; i++)
+                    {
+                        auto count = block->handler_latency[i].load(std::memory_order_relaxed);
+                        snapshot.handler_latency.buckets[i] += count;
+                        snapshot.handler_latency.count += count;
+                    }
+                }
+
+                for (std::size_t i = 0; i < PacketIdSlots; i++)
+                    if (handled[i])
+                        snapshot.handled_packets.emplace_back(i, handled[i]);
+
+                return snapshot;
+            }
+
+        private:
+            Registry()
+                : _startTicks(Timestamp()), _startTime(std::chrono::steady_clock::now())
+            {}
+
+            detail::ThreadCounters& Acquire()
+            {
+                std::lock_guard lg{ _lock };
+
+                for (auto& block : _blocks)
+                {
+                    bool expected = false;
+                    if (block->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                        return *block;
+                }
+
+                _blocks.push_back(std::make_unique<detail::ThreadCounters>());
+                return *_blocks.back();
+            }
+
+            // The TSC rate is measured against the steady clock over the registry's whole lifetime
+            double TicksPerNanosecond() const
+            {
+#if defined(GSPP_METRICS_HAS_TSC)
+                auto nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - _startTime).count();
+                auto ticks = (double)(Timestamp() - _startTicks);
+
+                return (nanoseconds > 0 && ticks > 0) ? ticks / nanoseconds : 1.0;
+#else
+                return 1.0;
+#endif
+            }
+
+            uint64_t _startTicks;
+            std::chrono::steady_clock::time_point _startTime;
+
+            std::mutex _lock;
+            std::vector<std::unique_ptr<detail::ThreadCounters>> _blocks;
+        };
+
+        inline void CountTraffic(Transport transport, Direction direction, std::size_t bytes, std::size_t packets = 1)
+        {
+            auto& local = Registry::GetInstance().Local();
+            auto index = (std::size_t)transport * DirectionCount + (std::size_t)direction;
+
+            detail::Bump(local.bytes[index], bytes);
+            detail::Bump(local.packets[index], packets);
+        }
+
+        template<class IdType>
+        void CountHandled(const IdType& id, uint64_t startTicks)
+        {
+            auto elapsed = Timestamp() - startTicks;
+            auto& local = Registry::GetInstance().Local();
+
+            // Sharing slots between ids would make their counts meaningless, so ids without one are only totalled
+            std::size_t slot;
+            if (detail::IdSlot(id, slot))
+                detail::Bump(local.handled[slot]);
+            else
+                detail::Bump(local.handled_other);
+
+            detail::Bump(local.handler_latency[detail::Log2(elapsed)]);
+        }
+
+        /// @brief Tracks a write queue's depth and high-water mark. Updated by the writer, readable from anywhere.
+        class QueueGauge
+        {
+        public:
+            void Set(uint64_t depth)
+            {
+                _depth.store(depth, std::memory_order_relaxed);
+
+                if (depth > _highWater.load(std::memory_order_relaxed))
+                    _highWater.store(depth, std::memory_order_relaxed);
+            }
+
+            QueueMetrics Get() const
+            {
+                return { _depth.load(std::memory_order_relaxed), _highWater.load(std::memory_order_relaxed) };
+            }
+
+        private:
+            std::atomic<uint64_t> _depth{ 0 };
+            std::atomic<uint64_t> _highWater{ 0 };
+        };
+
+        /// @brief Pull-style export: sums every thread's counters at the time of the call.
+        inline Snapshot Collect()
+        {
+            return Registry::GetInstance().Collect();
+        }
+#else
+        inline Snapshot Collect()
+        {
+            return {};
+        }
+#endif
+    }
+}
+
+#if defined(GSPP_ENABLE_METRICS)
+#define GSPP_METRIC_TRAFFIC(transport, direction, bytes) \
+    ::gspp::metrics::CountTraffic(::gspp::metrics::Transport::transport, ::gspp::metrics::Direction::direction, (bytes))
+#define GSPP_METRIC_TRAFFIC_BATCH(transport, direction, bytes, packets) \
+    ::gspp::metrics::CountTraffic(::gspp::metrics::Transport::transport, ::gspp::metrics::Direction::direction, (bytes), (packets))
+#define GSPP_METRIC_TIMESTAMP(name) const auto name = ::gspp::metrics::Timestamp()
+#define GSPP_METRIC_HANDLED(id, start) ::gspp::metrics::CountHandled((id), (start))
+#define GSPP_METRIC_QUEUE_GAUGE(name) ::gspp::metrics::QueueGauge name
+#define GSPP_METRIC_QUEUE_DEPTH(gauge, depth) (gauge).Set(depth)
+#else
+// Arguments are still evaluated as discarded values so that whatever only feeds the metrics doesn't count as unused
+#define GSPP_METRIC_TRAFFIC(transport, direction, bytes) ((void)(bytes))
+#define GSPP_METRIC_TRAFFIC_BATCH(transport, direction, bytes, packets) ((void)(bytes), (void)(packets))
+#define GSPP_METRIC_TIMESTAMP(name) [[maybe_unused]] const uint64_t name = 0
+#define GSPP_METRIC_HANDLED(id, start) ((void)(id), (void)(start))
+#define GSPP_METRIC_QUEUE_GAUGE(name)
+#define GSPP_METRIC_QUEUE_DEPTH(gauge, depth) ((void)(depth))
+#endif
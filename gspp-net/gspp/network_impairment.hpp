@@ -0,0 +1,191 @@
+//
+//  network_impairment.hpp
+//  gspp-net
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+
+namespace gspp
+{
+    struct ImpairmentSettings
+    {
+        /// @brief The base one-way delay added to everything passing through.
+        std::chrono::microseconds latency{ 0 };
+
+        /// @brief A random delay of up to this much is added on top of the latency.
+        std::chrono::microseconds jitter{ 0 };
+
+        /// @brief The probability of a datagram being dropped, within [0, 1].
+        double loss = 0.0;
+
+        /// @brief The probability of a datagram being held back by reorder_delay so that later ones overtake it.
+        double reorder = 0.0;
+        std::chrono::microseconds reorder_delay{ 20000 };
+
+        /// @brief The probability of a datagram being delivered twice.
+        double duplicate = 0.0;
+
+        /// @brief The link capacity in bytes per second, 0 meaning unlimited.
+        std::size_t bandwidth = 0;
+
+        /// @brief Datagrams that would wait in the bandwidth-limited link for longer than this are tail-dropped.
+        std::chrono::microseconds max_queue_delay{ 250000 };
+    };
+
+    /// @brief Simulates a bad network link in-process. Everything submitted is delivered later on the executor,
+    /// after applying the configured latency, jitter, loss, reordering, duplication and bandwidth limit.
+    ///
+    /// Ordered submissions (stream data) are never lost, duplicated or reordered: they only get delayed,
+    /// and every one of them is delivered after the previous one.
+    class NetworkImpairment : public std::enable_shared_from_this<NetworkImpairment>
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        NetworkImpairment(boost::asio::any_io_executor executor, ImpairmentSettings settings = {}, uint32_t seed = std::random_device{}())
+            : _timer(executor), _settings(settings), _random(seed)
+        {}
+
+        NetworkImpairment(const NetworkImpairment&) = delete;
+        NetworkImpairment(NetworkImpairment&&) = delete;
+
+        ImpairmentSettings settings() const
+        {
+            std::lock_guard lg{ _lock };
+            return _settings;
+        }
+
+        void SetSettings(const ImpairmentSettings& settings)
+        {
+            std::lock_guard lg{ _lock };
+            _settings = settings;
+        }
+
+        /// @brief Passes a unit of data through the simulated link.
+        /// @param bytes The size of the data, used for the bandwidth limit
+        /// @param deliver Invoked on the executor once per delivered copy (so possibly never, or twice)
+        /// @param ordered Whether the data belongs to an ordered, lossless stream
+        void Submit(std::size_t bytes, std::function<void()> deliver, bool ordered = false)
+        {
+            std::lock_guard lg{ _lock };
+
+            auto now = Clock::now();
+            auto departure = now;
+
+            if (_settings.bandwidth)
+            {
+                auto transmission = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((double)bytes / _settings.bandwidth));
+
+                departure = std::max(now, _linkFreeAt) + transmission;
+
+                if (!ordered && departure - now > _settings.max_queue_delay)
+                    return;
+
+                _linkFreeAt = departure;
+            }
+
+            if (!ordered && Chance(_settings.loss))
+                return;
+
+            auto due = departure + _settings.latency + Jitter();
+
+            if (ordered)
+            {
+                due = std::max(due, _lastOrderedDue);
+                _lastOrderedDue = due;
+            }
+            else
+            {
+                if (Chance(_settings.reorder))
+                    due += _settings.reorder_delay;
+
+                if (Chance(_settings.duplicate))
+                    Schedule(due + Jitter(), deliver);
+            }
+
+            Schedule(due, std::move(deliver));
+        }
+
+    private:
+        bool Chance(double probability)
+        {
+            return probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(_random) < probability;
+        }
+
+        Clock::duration Jitter()
+        {
+            if (_settings.jitter.count() <= 0)
+                return Clock::duration::zero();
+
+            return std::chrono::microseconds(std::uniform_int_distribution<long long>(0, _settings.jitter.count())(_random));
+        }
+
+        void Schedule(Clock::time_point due, std::function<void()> deliver)
+        {
+            // Equal keys keep their insertion order, which is what keeps ordered submissions in order
+            _pending.emplace(due, std::move(deliver));
+
+            if (_pending.begin()->first == due && (!_armed || due < _armedFor))
+                Arm(due);
+        }
+
+        void Arm(Clock::time_point due)
+        {
+            _armed = true;
+            _armedFor = due;
+            _timer.expires_at(due);
+
+            auto self = this->shared_from_this();
+            _timer.async_wait(
+                [self](const boost::system::error_code& ec)
+                {
+                    if (ec != boost::asio::error::operation_aborted)
+                        self->Fire();
+                });
+        }
+
+        void Fire()
+        {
+            std::unique_lock lock{ _lock };
+
+            _armed = false;
+
+            auto now = Clock::now();
+
+            while (!_pending.empty() && _pending.begin()->first <= now)
+            {
+                auto deliver = std::move(_pending.begin()->second);
+                _pending.erase(_pending.begin());
+
+                lock.unlock();
+                deliver();
+                lock.lock();
+            }
+
+            if (!_pending.empty() && !_armed)
+                Arm(_pending.begin()->first);
+        }
+
+        boost::asio::steady_timer _timer;
+
+        mutable std::mutex _lock;
+        ImpairmentSettings _settings;
+        std::mt19937 _random;
+
+        Clock::time_point _linkFreeAt;
+        Clock::time_point _lastOrderedDue;
+
+        bool _armed = false;
+        Clock::time_point _armedFor;
+        std::multimap<Clock::time_point, std::function<void()>> _pending;
+    };
+}
@@ -8,9 +8,14 @@
 
 #pragma once
 #include <plakpacs/plakpacs.hpp>
+#include <bpacs/arena.hpp>
 #include <unordered_map>
 #include <memory>
+#include <optional>
+#include <tuple>
+#include <utility>
 
+#include "metrics.hpp"
 #include "packet_serializer.hpp"
 
 namespace gspp
@@ -45,11 +50,29 @@ namespace gspp
         public:
             virtual HandlerResult HandlePacket(State& state, const Header& header, ReadStream& stream) const override
             {
-                auto schema = plakpacs::serializer::read<Schema>(stream);
-                return PacketHandlerFunction<Schema>::Handle(state, {header, schema});
+                // Schemas with plakpacs::pmr containers are decoded into this thread's packet arena and freed in one go
+                // once the handler returns. Anything a handler keeps has to be copied out of the packet, which puts
+                // the copy on the heap; containers it creates itself go to the heap too
+                auto& arena = PacketArena();
+                bpacs::arena_checkpoint checkpoint{ arena };
+
+                std::optional<std::pair<Header, Schema>> packet;
+                {
+                    bpacs::arena_scope scope{ arena };
+                    packet.emplace(std::piecewise_construct, std::forward_as_tuple(header), std::forward_as_tuple());
+                    plakpacs::serializer::read(stream, packet->second);
+                }
+
+                return PacketHandlerFunction<Schema>::Handle(state, *packet);
             }
         };
 
+        static bpacs::arena& PacketArena()
+        {
+            thread_local bpacs::arena arena;
+            return arena;
+        }
+
     public:
         class HandlerManager
         {
@@ -81,7 +104,7 @@ namespace gspp
             template<class RSConvertible>
             HandlerResult HandlePacket(State& state, const RSConvertible& bytes)
             {
-                plakpacs::read_stream rs{ bytes };
+                ReadStream rs{ bytes };
                 return HandlePacket(state, rs);
             }
 
@@ -92,10 +115,17 @@ namespace gspp
 
             HandlerResult HandlePacket(State& state, const Header& header, ReadStream& rs)
             {
-                auto it = _handlers.find(HeaderIdExtractor::Extract(header));
+                auto id = HeaderIdExtractor::Extract(header);
+                auto it = _handlers.find(id);
 
                 if (it != _handlers.end())
-                    return (*it).second->HandlePacket(state, header, rs);
+                {
+                    GSPP_METRIC_TIMESTAMP(start);
+                    auto result = (*it).second->HandlePacket(state, header, rs);
+                    GSPP_METRIC_HANDLED(id, start);
+
+                    return result;
+                }
                 else
                     return HandlerResult::Continue; // might wanna throw instead
             }
@@ -111,7 +141,7 @@ namespace gspp
         template<class Schema>
         struct HandlerRegistrator
         {
-            HandlerRegistrator<Schema>()
+            HandlerRegistrator()
             {
                 HandlerManager::GetInstance().template RegisterHandler<Schema>();
             }
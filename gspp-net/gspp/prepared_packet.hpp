@@ -0,0 +1,115 @@
+//
+//  prepared_packet.hpp
+//  gspp-net
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bacs/bacs.hpp>
+#include <plakpacs/plakpacs.hpp>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "packet_serializer.hpp"
+
+namespace gspp
+{
+    /// @brief An immutable, already serialized packet. Copies share the same bytes, so one PreparedPacket can be
+    /// queued on any number of connections without being serialized or copied again.
+    class PreparedPacket
+    {
+    public:
+        PreparedPacket() = default;
+
+        explicit PreparedPacket(bacs::shared_buffer bytes)
+            : _bytes(std::move(bytes))
+        {}
+
+        PreparedPacket(const uint8_t* data, std::size_t size)
+            : _bytes(size)
+        {
+            if (size)
+                std::memcpy(_bytes.data(), data, size);
+        }
+
+        template<class Packet>
+        static PreparedPacket Make(const Packet& packet)
+        {
+            auto ws = PacketSerializer<Packet>::template Serialize<plakpacs::write_stream>(packet);
+            return PreparedPacket(ws.bytes().data(), ws.bytes().size());
+        }
+
+        const uint8_t* data() const
+        {
+            return _bytes.begin();
+        }
+
+        std::size_t size() const
+        {
+            return _bytes.size();
+        }
+
+        const bacs::shared_buffer& buffer() const
+        {
+            return _bytes;
+        }
+
+    private:
+        bacs::shared_buffer _bytes;
+    };
+
+    namespace detail
+    {
+        template<class T, class = void>
+        struct is_dereferenceable : std::false_type
+        {};
+
+        template<class T>
+        struct is_dereferenceable<T, std::void_t<decltype(*std::declval<T&>())>> : std::true_type
+        {};
+
+        template<class T>
+        auto& Deref(T& connection)
+        {
+            if constexpr (is_dereferenceable<T>::value)
+                return *connection;
+            else
+                return connection;
+        }
+    }
+
+    /// @brief Queues one prepared packet on every connection in the range. Works with anything that has Send(const PreparedPacket&),
+    /// held by value, pointer or smart pointer.
+    /// @return The number of connections that accepted the packet
+    template<class ConnectionRange>
+    std::size_t Broadcast(ConnectionRange& connections, const PreparedPacket& packet)
+    {
+        std::size_t sent = 0;
+
+        for (auto& connection : connections)
+        {
+            auto& target = detail::Deref(connection);
+
+            if constexpr (std::is_same_v<decltype(target.Send(packet)), bool>)
+            {
+                sent += target.Send(packet) ? 1 : 0;
+            }
+            else
+            {
+                target.Send(packet);
+                sent++;
+            }
+        }
+
+        return sent;
+    }
+
+    /// @brief Serializes the packet once and queues it on every connection in the range.
+    template<class ConnectionRange, class Packet>
+    std::size_t Broadcast(ConnectionRange& connections, const Packet& packet)
+    {
+        return Broadcast(connections, PreparedPacket::Make(packet));
+    }
+}
@@ -0,0 +1,674 @@
+//
+//  reliable_client.hpp
+//  gspp-net
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bacs/bacs.hpp>
+#include <plakpacs/plakpacs.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <boost/asio.hpp>
+
+#include "metrics.hpp"
+#include "packet_serializer.hpp"
+#include "prepared_packet.hpp"
+#include "datagram_connection.hpp"
+#include "datagram_client.hpp"
+
+namespace gspp
+{
+    enum class ReliableChannelType
+    {
+        ReliableOrdered,
+        ReliableUnordered,
+        Unreliable
+    };
+
+    struct ReliableConfig
+    {
+        /// @brief One entry per channel. Channels never block each other: a lost message only stalls its own channel.
+        std::vector<ReliableChannelType> channels = { ReliableChannelType::ReliableOrdered };
+
+        /// @brief The largest datagram payload produced, headers included. Messages are packed into packets up to this size.
+        std::size_t max_packet_size = 1200;
+
+        /// @brief How long an unacknowledged reliable message waits before it is sent again.
+        std::chrono::milliseconds resend_interval{ 100 };
+
+        /// @brief How long the peer may stay silent before the connection is considered dead.
+        std::chrono::milliseconds timeout{ 10000 };
+
+        /// @brief How long an endpoint with nothing to say waits before sending an empty packet, which keeps an idle
+        /// connection from timing out on the other side. Should be well below the timeout.
+        std::chrono::milliseconds keepalive_interval{ 1000 };
+    };
+
+    namespace detail
+    {
+        inline bool sequence_greater_than(uint16_t a, uint16_t b)
+        {
+            return ((a > b) && (a - b <= 32768)) || ((a < b) && (b - a > 32768));
+        }
+
+        inline bool sequence_less_than(uint16_t a, uint16_t b)
+        {
+            return sequence_greater_than(b, a);
+        }
+
+        template<class T>
+        void store_bytes(uint8_t* to, T value)
+        {
+            std::memcpy(to, &value, sizeof(T));
+        }
+
+        template<class T>
+        T load_bytes(const uint8_t* from)
+        {
+            T value;
+            std::memcpy(&value, from, sizeof(T));
+            return value;
+        }
+    }
+
+    /// @brief The transport-agnostic core of the reliability layer.
+    ///
+    /// Packets carry a sequence number, the latest remote sequence seen and a bitfield acknowledging the 32 packets before it.
+    /// Every packet holds any number of channel messages. Reliable messages stay queued until a packet that carried them
+    /// is acknowledged and only those are resent, so a single loss never retransmits the rest of the stream.
+    ///
+    /// Packets go out through the transmit function, which makes it easy to put a loss/latency simulator in between.
+    class ReliableEndpoint
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using TransmitFunction = std::function<void(const uint8_t*, std::size_t)>;
+        using DeliverFunction = std::function<void(std::size_t, bacs::shared_buffer&)>;
+
+        static constexpr std::size_t PacketWindow = 256;
+        static constexpr std::size_t MessageWindow = 256;
+        static constexpr std::size_t MaxMessagesPerPacket = 32;
+        static constexpr std::size_t PacketHeaderSize = sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint32_t);
+        static constexpr std::size_t MessageHeaderSize = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t);
+
+        ReliableEndpoint(ReliableConfig config, TransmitFunction transmit, DeliverFunction deliver)
+            : _config(std::move(config)), _transmit(std::move(transmit)), _deliver(std::move(deliver)),
+              _lastReceive(Clock::now()), _lastSend(_lastReceive)
+        {
+            if (_config.channels.empty() || _config.channels.size() > 0xFF)
+                throw std::runtime_error("gspp::ReliableEndpoint: channel count must be within [1, 255]");
+
+            if (_config.max_packet_size <= PacketHeaderSize + MessageHeaderSize)
+                throw std::runtime_error("gspp::ReliableEndpoint: max_packet_size is too small");
+
+            for (auto type : _config.channels)
+            {
+                auto& channel = _channels.emplace_back();
+                channel.type = type;
+
+                if (type != ReliableChannelType::Unreliable)
+                {
+                    channel.send_window.resize(MessageWindow);
+                    channel.recv_window.resize(MessageWindow);
+                }
+            }
+
+            _packet.reserve(_config.max_packet_size);
+        }
+
+        ReliableEndpoint(const ReliableEndpoint&) = delete;
+        ReliableEndpoint(ReliableEndpoint&&) = delete;
+
+        std::size_t max_message_size() const
+        {
+            return std::min<std::size_t>(_config.max_packet_size - PacketHeaderSize - MessageHeaderSize, 0xFFFF);
+        }
+
+        /// @brief Queues a message. It goes out on the next Update().
+        void SendMessage(std::size_t channel, bacs::shared_buffer message)
+        {
+            if (channel >= _channels.size())
+                throw std::runtime_error("gspp::ReliableEndpoint.SendMessage: invalid channel");
+
+            if (message.size() > max_message_size())
+                throw std::runtime_error("gspp::ReliableEndpoint.SendMessage: message does not fit into a packet");
+
+            std::lock_guard lg{ _lock };
+            _channels[channel].backlog.push_back(std::move(message));
+        }
+
+        void SendMessage(std::size_t channel, const uint8_t* data, std::size_t size)
+        {
+            bacs::shared_buffer message{ size };
+            std::memcpy(message.data(), data, size);
+            SendMessage(channel, std::move(message));
+        }
+
+        /// @brief Processes an incoming packet located at [offset, offset + size) of the buffer.
+        /// Messages delivered right away share the buffer instead of being copied.
+        /// @return false if the packet was malformed
+        bool ReceivePacket(const bacs::shared_buffer& buffer, std::size_t offset, std::size_t size,
+                           Clock::time_point now = Clock::now())
+        {
+            if (size < PacketHeaderSize || offset + size > buffer.size())
+                return false;
+
+            auto data = buffer.begin() + offset;
+            auto sequence = detail::load_bytes<uint16_t>(data);
+            auto ack = detail::load_bytes<uint16_t>(data + 2);
+            auto ackBits = detail::load_bytes<uint32_t>(data + 4);
+
+            std::lock_guard lg{ _lock };
+
+            _lastReceive = now;
+
+            bool fresh = AcceptSequence(sequence);
+
+            ProcessAck(ack, now);
+
+            for (uint16_t i = 0; i < 32; i++)
+                if (ackBits & (1u << i))
+                    ProcessAck((uint16_t)(ack - 1 - i), now);
+
+            if (!fresh)
+                return true;
+
+            // Packets without messages are acks and keepalives; acking them back would never let the link go quiet
+            if (size > PacketHeaderSize)
+                _ackPending = true;
+
+            for (std::size_t position = PacketHeaderSize; position < size;)
+            {
+                if (position + MessageHeaderSize > size)
+                    return false;
+
+                auto channel = detail::load_bytes<uint8_t>(data + position);
+                auto id = detail::load_bytes<uint16_t>(data + position + 1);
+                auto length = detail::load_bytes<uint16_t>(data + position + 3);
+                position += MessageHeaderSize;
+
+                if (channel >= _channels.size() || position + length > size)
+                    return false;
+
+                ReceiveMessage(_channels[channel], channel, id, buffer.slice(offset + position, length));
+                position += length;
+            }
+
+            return true;
+        }
+
+        /// @brief Sends new messages, resends timed out ones and acknowledges what was received since the last update.
+        /// An endpoint that has sent nothing for keepalive_interval sends an empty packet.
+        void Update(Clock::time_point now = Clock::now())
+        {
+            std::lock_guard lg{ _lock };
+
+            BeginPacket();
+
+            for (std::size_t c = 0; c < _channels.size(); c++)
+            {
+                auto& channel = _channels[c];
+
+                if (channel.type == ReliableChannelType::Unreliable)
+                {
+                    for (auto& message : channel.backlog)
+                        AppendMessage(c, channel.send_next_id++, message, false, now);
+
+                    channel.backlog.clear();
+                    continue;
+                }
+
+                // Move whatever fits into the send window
+                while (!channel.backlog.empty() && (uint16_t)(channel.send_next_id - channel.send_oldest_id) < MessageWindow)
+                {
+                    auto& slot = channel.send_window[channel.send_next_id % MessageWindow];
+                    slot.valid = true;
+                    slot.id = channel.send_next_id++;
+                    slot.data = std::move(channel.backlog.front());
+                    slot.sent = false;
+
+                    channel.backlog.pop_front();
+                }
+
+                for (auto id = channel.send_oldest_id; id != channel.send_next_id; id++)
+                {
+                    auto& slot = channel.send_window[id % MessageWindow];
+
+                    if (!slot.valid || (slot.sent && now - slot.last_sent < _config.resend_interval))
+                        continue;
+
+                    AppendMessage(c, id, slot.data, true, now);
+
+                    slot.sent = true;
+                    slot.last_sent = now;
+                }
+            }
+
+            if (_packetMessages > 0 || _ackPending || now - _lastSend >= _config.keepalive_interval)
+                FinishPacket(now);
+        }
+
+        Clock::time_point last_receive_time() const
+        {
+            std::lock_guard lg{ _lock };
+            return _lastReceive;
+        }
+
+        /// @brief The smoothed round trip time measured from acknowledgements.
+        Clock::duration rtt() const
+        {
+            std::lock_guard lg{ _lock };
+            return _rtt;
+        }
+
+    private:
+        struct OutgoingMessage
+        {
+            bool valid = false;
+            bool sent = false;
+            uint16_t id = 0;
+            bacs::shared_buffer data;
+            Clock::time_point last_sent;
+        };
+
+        struct IncomingMessage
+        {
+            bool valid = false;
+            uint16_t id = 0;
+            bacs::shared_buffer data;
+        };
+
+        struct Channel
+        {
+            ReliableChannelType type;
+
+            uint16_t send_next_id = 0;
+            uint16_t send_oldest_id = 0;
+            std::vector<OutgoingMessage> send_window;
+            std::deque<bacs::shared_buffer> backlog;
+
+            uint16_t recv_next_id = 0;
+            std::vector<IncomingMessage> recv_window;
+        };
+
+        struct MessageRef
+        {
+            uint8_t channel;
+            uint16_t id;
+        };
+
+        struct SentPacket
+        {
+            bool valid = false;
+            bool acked = false;
+            uint16_t sequence = 0;
+            Clock::time_point time;
+            std::size_t num_messages = 0;
+            std::array<MessageRef, MaxMessagesPerPacket> messages;
+        };
+
+        struct ReceivedPacket
+        {
+            bool valid = false;
+            uint16_t sequence = 0;
+        };
+
+        void BeginPacket()
+        {
+            _packet.resize(PacketHeaderSize);
+            _packetMessages = 0;
+            _packetReliableMessages = 0;
+        }
+
+        void AppendMessage(std::size_t channel, uint16_t id, const bacs::shared_buffer& message, bool reliable,
+                           Clock::time_point now)
+        {
+            if (_packet.size() + MessageHeaderSize + message.size() > _config.max_packet_size ||
+                _packetMessages == MaxMessagesPerPacket)
+            {
+                FinishPacket(now);
+                BeginPacket();
+            }
+
+            auto position = _packet.size();
+            _packet.resize(position + MessageHeaderSize + message.size());
+
+            auto data = _packet.data() + position;
+            detail::store_bytes<uint8_t>(data, (uint8_t)channel);
+            detail::store_bytes<uint16_t>(data + 1, id);
+            detail::store_bytes<uint16_t>(data + 3, (uint16_t)message.size());
+            std::memcpy(data + MessageHeaderSize, message.data(), message.size());
+
+            if (reliable)
+                _sentRefs[_packetReliableMessages++] = { (uint8_t)channel, id };
+
+            _packetMessages++;
+        }
+
+        void FinishPacket(Clock::time_point now)
+        {
+            auto sequence = _localSequence++;
+
+            uint32_t ackBits = 0;
+            for (uint16_t i = 0; i < 32; i++)
+            {
+                auto& received = _received[(uint16_t)(_remoteSequence - 1 - i) % PacketWindow];
+                if (received.valid && received.sequence == (uint16_t)(_remoteSequence - 1 - i))
+                    ackBits |= 1u << i;
+            }
+
+            detail::store_bytes<uint16_t>(_packet.data(), sequence);
+            detail::store_bytes<uint16_t>(_packet.data() + 2, _remoteSequence);
+            detail::store_bytes<uint32_t>(_packet.data() + 4, ackBits);
+
+            auto& sent = _sent[sequence % PacketWindow];
+            sent.valid = true;
+            sent.acked = false;
+            sent.sequence = sequence;
+            sent.time = now;
+            sent.num_messages = _packetReliableMessages;
+            std::copy(_sentRefs.begin(), _sentRefs.begin() + _packetReliableMessages, sent.messages.begin());
+
+            _ackPending = false;
+            _lastSend = now;
+
+            if (_transmit)
+                _transmit(_packet.data(), _packet.size());
+        }
+
+        /// @return false if the packet is a duplicate or too old to be tracked anymore
+        bool AcceptSequence(uint16_t sequence)
+        {
+            auto& slot = _received[sequence % PacketWindow];
+
+            if (slot.valid && slot.sequence == sequence)
+                return false;
+
+            if (!_hasRemote || detail::sequence_greater_than(sequence, _remoteSequence))
+            {
+                // Forget the slots skipped over so that old sequences do not alias into the new window
+                if (_hasRemote)
+                    for (auto s = (uint16_t)(_remoteSequence + 1); s != sequence && (uint16_t)(s - _remoteSequence) <= PacketWindow; s++)
+                        _received[s % PacketWindow].valid = false;
+
+                _remoteSequence = sequence;
+                _hasRemote = true;
+            }
+            else if ((uint16_t)(_remoteSequence - sequence) >= PacketWindow)
+            {
+                return false;
+            }
+
+            slot.valid = true;
+            slot.sequence = sequence;
+
+            return true;
+        }
+
+        void ProcessAck(uint16_t sequence, Clock::time_point now)
+        {
+            auto& sent = _sent[sequence % PacketWindow];
+
+            if (!sent.valid || sent.acked || sent.sequence != sequence)
+                return;
+
+            sent.acked = true;
+
+            auto sample = now - sent.time;
+            _rtt = (_rtt == Clock::duration::zero()) ? sample : _rtt + (sample - _rtt) / 8;
+
+            for (std::size_t i = 0; i < sent.num_messages; i++)
+            {
+                auto& ref = sent.messages[i];
+                auto& channel = _channels[ref.channel];
+                auto& slot = channel.send_window[ref.id % MessageWindow];
+
+                if (slot.valid && slot.id == ref.id)
+                {
+                    slot.valid = false;
+                    slot.data = {};
+                }
+
+                while (channel.send_oldest_id != channel.send_next_id &&
+                       !channel.send_window[channel.send_oldest_id % MessageWindow].valid)
+                    channel.send_oldest_id++;
+            }
+        }
+
+        void ReceiveMessage(Channel& channel, std::size_t index, uint16_t id, bacs::shared_buffer message)
+        {
+            if (channel.type == ReliableChannelType::Unreliable)
+            {
+                Deliver(index, message);
+                return;
+            }
+
+            // Already delivered, or too far ahead to be buffered
+            if (detail::sequence_less_than(id, channel.recv_next_id) ||
+                (uint16_t)(id - channel.recv_next_id) >= MessageWindow)
+                return;
+
+            auto& slot = channel.recv_window[id % MessageWindow];
+
+            if (slot.valid && slot.id == id)
+                return;
+
+            if (channel.type == ReliableChannelType::ReliableUnordered)
+            {
+                slot.valid = true;
+                slot.id = id;
+                Deliver(index, message);
+
+                while (channel.recv_window[channel.recv_next_id % MessageWindow].valid &&
+                       channel.recv_window[channel.recv_next_id % MessageWindow].id == channel.recv_next_id)
+                    channel.recv_window[channel.recv_next_id++ % MessageWindow].valid = false;
+
+                return;
+            }
+
+            if (id != channel.recv_next_id)
+            {
+                // Out of order: keep a private copy so the datagram buffer does not stay pinned while we wait
+                slot.valid = true;
+                slot.id = id;
+                slot.data = bacs::shared_buffer{ message.size() };
+                std::memcpy(slot.data.data(), message.data(), message.size());
+                return;
+            }
+
+            Deliver(index, message);
+            channel.recv_next_id++;
+
+            for (;;)
+            {
+                auto& next = channel.recv_window[channel.recv_next_id % MessageWindow];
+
+                if (!next.valid || next.id != channel.recv_next_id)
+                    break;
+
+                auto data = std::move(next.data);
+                next.valid = false;
+                channel.recv_next_id++;
+
+                Deliver(index, data);
+            }
+        }
+
+        void Deliver(std::size_t channel, bacs::shared_buffer& message)
+        {
+            if (_deliver)
+                _deliver(channel, message);
+        }
+
+        ReliableConfig _config;
+        TransmitFunction _transmit;
+        DeliverFunction _deliver;
+
+        // Recursive so that delivery handlers may send replies straight away
+        mutable std::recursive_mutex _lock;
+
+        std::vector<Channel> _channels;
+
+        uint16_t _localSequence = 0;
+        std::array<SentPacket, PacketWindow> _sent;
+
+        bool _hasRemote = false;
+        bool _ackPending = false;
+        uint16_t _remoteSequence = 0xFFFF;
+        std::array<ReceivedPacket, PacketWindow> _received;
+
+        std::vector<uint8_t> _packet;
+        std::size_t _packetMessages = 0;
+        std::size_t _packetReliableMessages = 0;
+        std::array<MessageRef, MaxMessagesPerPacket> _sentRefs;
+
+        Clock::time_point _lastReceive;
+        Clock::time_point _lastSend;
+        Clock::duration _rtt = Clock::duration::zero();
+    };
+
+    /// @brief A reliable, channelled transport running over a DatagramConnection.
+    ///
+    /// Mirrors the StreamClient interface, so DualConnection<ReliableClient<...>, ...> works as a drop-in replacement
+    /// for TCP: its Socket is the DatagramClient (connection + peer endpoint) to talk over.
+    /// Since one DatagramConnection serves many peers, its handler has to route incoming datagrams to the right
+    /// client's ReceiveDatagram(), and the owner has to call Update() every tick.
+    template<class Protocol, class SPTraits = bacs::sp_default, size_t RecvSize = 0xFFFF, class ConnectionType = DatagramConnection<Protocol, SPTraits, RecvSize>>
+    class ReliableClient
+    {
+    public:
+        using Socket = DatagramClient<Protocol, SPTraits, RecvSize, ConnectionType>;
+        using Endpoint = typename Socket::Endpoint;
+        using Clock = ReliableEndpoint::Clock;
+        using HandleFunction = bacs::unique_function<bool(bacs::shared_buffer&)>;
+        using DeathFunction = bacs::unique_function<void(const boost::system::error_code&)>;
+
+        ReliableClient(Socket&& link, HandleFunction onHandle = {}, DeathFunction onDeath = {}, ReliableConfig config = {})
+            : _link(std::move(link)), _onHandle(std::move(onHandle)), _onDeath(std::move(onDeath)), _timeout(config.timeout),
+              _endpoint(std::move(config),
+                        [this](const uint8_t* data, std::size_t size)
+                        {
+                            _link.connection()->EnqueueBytes(_link.endpoint(), data, size);
+                        },
+                        [this](std::size_t, bacs::shared_buffer& message)
+                        {
+                            GSPP_METRIC_TRAFFIC(Reliable, In, message.size());
+
+                            if (_receiving && _onHandle && !_onHandle(message))
+                                _receiving = false;
+                        })
+        {}
+
+        ReliableClient() = delete;
+        ReliableClient(const ReliableClient&) = delete;
+        ReliableClient(ReliableClient&& other) = delete;
+
+        Endpoint endpoint() const
+        {
+            return _link.endpoint();
+        }
+
+        ReliableEndpoint& reliable()
+        {
+            return _endpoint;
+        }
+
+        void StartReceiveLoop()
+        {
+            _started = true;
+            _receiving = true;
+        }
+
+        /// @brief Feeds a datagram received from this client's peer, exactly as handed out by the DatagramConnection.
+        void ReceiveDatagram(const bacs::shared_buffer& buffer, std::size_t bytes_transferred)
+        {
+            // Not acknowledging anything before the receive loop starts makes the peer resend it later on
+            if (!_receiving)
+                return;
+
+            using size_type = typename SPTraits::size_type;
+
+            if (bytes_transferred < sizeof(size_type))
+                return;
+
+            size_type size;
+            std::memcpy(&size, buffer.data(), sizeof(size));
+            SPTraits::in(size);
+
+            if (size > bytes_transferred - sizeof(size_type))
+                return;
+
+            _endpoint.ReceivePacket(buffer, sizeof(size_type), size);
+        }
+
+        template<class Packet>
+        void Send(const Packet& packet, std::size_t channel = 0)
+        {
+            auto ws = PacketSerializer<Packet>::template Serialize<plakpacs::write_stream>(packet);
+            GSPP_METRIC_TRAFFIC(Reliable, Out, ws.bytes().size());
+
+            _endpoint.SendMessage(channel, ws.bytes().data(), ws.bytes().size());
+        }
+
+        /// @brief Sends an already serialized packet. The reliability layer keeps sharing its bytes until they're acked.
+        bool Send(const PreparedPacket& packet, std::size_t channel = 0)
+        {
+            GSPP_METRIC_TRAFFIC(Reliable, Out, packet.size());
+
+            _endpoint.SendMessage(channel, packet.buffer());
+            return true;
+        }
+
+        /// @brief Runs the reliability layer and detects timeouts.
+        /// @param flush Whether to flush the datagram connection afterwards. When updating many clients sharing
+        /// one connection, pass false and flush the connection once at the end of the tick instead.
+        void Update(Clock::time_point now = Clock::now(), bool flush = true)
+        {
+            if (_dead)
+                return;
+
+            _endpoint.Update(now);
+
+            if (flush)
+                _link.connection()->Flush();
+
+            if (_receiving && now - _endpoint.last_receive_time() > _timeout)
+                Die(boost::asio::error::timed_out);
+        }
+
+        void CloseSocket()
+        {
+            if (_started)
+                Die(boost::asio::error::operation_aborted);
+        }
+
+    private:
+        void Die(const boost::system::error_code& ec)
+        {
+            _receiving = false;
+
+            if (!_dead.exchange(true) && _onDeath)
+                _onDeath(ec);
+        }
+
+        Socket _link;
+        HandleFunction _onHandle;
+        DeathFunction _onDeath;
+        std::chrono::milliseconds _timeout;
+
+        std::atomic<bool> _started = false;
+        std::atomic<bool> _receiving = false;
+        std::atomic<bool> _dead = false;
+
+        ReliableEndpoint _endpoint;
+    };
+}
@@ -0,0 +1,169 @@
+//
+//  sharded_datagram_connection.hpp
+//  gspp-net
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <bacs/bacs.hpp>
+#include <plakpacs/plakpacs.hpp>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <boost/asio.hpp>
+
+#include "packet_serializer.hpp"
+#include "prepared_packet.hpp"
+#include "datagram_connection.hpp"
+
+namespace gspp
+{
+    /// @brief A datagram listener spread over several SO_REUSEPORT sockets bound to the same endpoint.
+    /// Every shard owns its socket, buffers and io_context thread, so the kernel can balance flows across cores.
+    /// Exposes the same send API as DatagramConnection and can be used as the connection type of a DatagramClient.
+    template<class Protocol, class SPTraits = bacs::sp_default, size_t RecvSize = 0xFFFF>
+    class ShardedDatagramConnection
+    {
+    public:
+        using Connection = DatagramConnection<Protocol, SPTraits, RecvSize>;
+        using Socket = typename Connection::Socket;
+        using Endpoint = typename Connection::Endpoint;
+        using Handler = typename Connection::Handler;
+
+        /// @brief Opens and binds the shards. The handler is invoked on the thread of the shard that received the datagram.
+        /// @param bindEp The endpoint to bind every shard to. If its port is 0, the port picked for the first shard is reused.
+        /// @param numShards The number of sockets and threads to use. Forced to 1 where SO_REUSEPORT is unavailable.
+        /// @param numReceives The number of receives each shard keeps in flight.
+        ShardedDatagramConnection(Endpoint bindEp, std::size_t numShards, Handler onHandle = {}, std::size_t numReceives = 1)
+        {
+#if !defined(SO_REUSEPORT)
+            numShards = 1;
+#endif
+            if (numShards == 0)
+                numShards = 1;
+
+            // Handlers are move-only, so the shards share one through a forwarding wrapper
+            auto shared = std::make_shared<Handler>(std::move(onHandle));
+
+            for (std::size_t i = 0; i < numShards; i++)
+            {
+                _shards.push_back(std::make_unique<Shard>(bindEp, ShardHandler(shared), numReceives));
+
+                // Pin the rest of the shards to whatever port the first one actually got
+                bindEp = _shards.front()->local_endpoint;
+            }
+        }
+
+        ShardedDatagramConnection() = delete;
+        ShardedDatagramConnection(const ShardedDatagramConnection&) = delete;
+        ShardedDatagramConnection(ShardedDatagramConnection&& other) = delete;
+
+        std::size_t num_shards() const
+        {
+            return _shards.size();
+        }
+
+        Endpoint local_endpoint() const
+        {
+            return _shards.front()->local_endpoint;
+        }
+
+        template<class Packet>
+        void Send(Endpoint ep, const Packet& packet)
+        {
+            ShardFor(ep).Send(ep, packet);
+        }
+
+        template<class Packet>
+        void Enqueue(Endpoint ep, const Packet& packet)
+        {
+            ShardFor(ep).Enqueue(ep, packet);
+        }
+
+        void EnqueueBytes(Endpoint ep, const uint8_t* data, std::size_t size)
+        {
+            ShardFor(ep).EnqueueBytes(ep, data, size);
+        }
+
+        std::size_t Flush()
+        {
+            std::size_t count = 0;
+
+            for (auto& shard : _shards)
+                count += shard->connection->Flush();
+
+            return count;
+        }
+
+        template<class EndpointRange, class Packet>
+        std::size_t SendBatch(const EndpointRange& endpoints, const Packet& packet)
+        {
+            return SendBatch(endpoints, PreparedPacket::Make(packet));
+        }
+
+        template<class EndpointRange>
+        std::size_t SendBatch(const EndpointRange& endpoints, const PreparedPacket& packet)
+        {
+            for (auto& ep : endpoints)
+                EnqueueBytes(ep, packet.data(), packet.size());
+
+            return Flush();
+        }
+
+    private:
+        struct Shard
+        {
+            // Declaration order matters: the worker has to stop before the connection closes its socket,
+            // and the context has to outlive both so pending handlers release their state last.
+            boost::asio::io_context context;
+            Endpoint local_endpoint;
+            std::shared_ptr<Connection> connection;
+            boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+            bacs::io_worker<boost::asio::io_context> worker;
+
+            Shard(const Endpoint& bindEp, Handler onHandle, std::size_t numReceives)
+                : connection(std::make_shared<Connection>(OpenSocket(context, bindEp, local_endpoint), std::move(onHandle), numReceives)),
+                  work(boost::asio::make_work_guard(context)), worker(context)
+            {}
+
+            static Socket OpenSocket(boost::asio::io_context& context, const Endpoint& bindEp, Endpoint& boundEp)
+            {
+                Socket socket{ context };
+                socket.open(bindEp.protocol());
+                socket.set_option(boost::asio::socket_base::reuse_address(true));
+#if defined(SO_REUSEPORT)
+                socket.set_option(bacs::reuse_port(true));
+#endif
+                socket.bind(bindEp);
+
+                boundEp = socket.local_endpoint();
+                return socket;
+            }
+        };
+
+        static Handler ShardHandler(const std::shared_ptr<Handler>& shared)
+        {
+            if (!*shared)
+                return {};
+
+            return [shared](Endpoint ep, bacs::shared_buffer buffer, std::size_t size)
+            {
+                (*shared)(std::move(ep), std::move(buffer), size);
+            };
+        }
+
+        Connection& ShardFor(const Endpoint& ep)
+        {
+            if (_shards.size() == 1)
+                return *_shards.front()->connection;
+
+            // Keep every peer on one socket so its datagrams leave in order
+            auto hash = std::hash<std::string_view>{}(std::string_view((const char*)ep.data(), ep.size()));
+            return *_shards[hash % _shards.size()]->connection;
+        }
+
+        std::vector<std::unique_ptr<Shard>> _shards;
+    };
+}
@@ -8,24 +8,56 @@
 
 #pragma once
 #include <bacs/bacs.hpp>
+#include <bacs/socket_profile.hpp>
 #include <plakpacs/plakpacs.hpp>
+#include <algorithm>
 #include <functional>
-#include <queue>
+#include <deque>
 #include <mutex>
+#include <atomic>
+#include <vector>
 #include <boost/asio.hpp>
 
+#include "metrics.hpp"
 #include "packet_serializer.hpp"
+#include "prepared_packet.hpp"
+#include "network_impairment.hpp"
 
 namespace gspp
 {
+    /// @brief What a StreamClient does with a message that would push its write queue over the high watermark.
+    enum class BackpressurePolicy
+    {
+        Signal,     // Queue it anyway and only report the congestion
+        DropNewest, // Drop the message being sent
+        DropOldest, // Drop queued messages, oldest first, until it fits. The message being written is never dropped
+        Disconnect  // Close the connection
+    };
+
+    struct BackpressureConfig
+    {
+        /// @brief Zero means no limit.
+        std::size_t high_water_bytes = 0;
+        std::size_t high_water_messages = 0;
+
+        /// @brief The connection stops being congested once its queue drains down to both of these.
+        std::size_t low_water_bytes = 0;
+        std::size_t low_water_messages = 0;
+
+        BackpressurePolicy policy = BackpressurePolicy::Signal;
+    };
+
 	template<class Protocol, class SPTraits = bacs::sp_default>
     class StreamClient
     {
     public:
         using Socket = typename Protocol::socket;
+        using HandleFunction = bacs::unique_function<bool(bacs::shared_buffer&)>;
+        using DeathFunction = bacs::unique_function<void(const boost::system::error_code&)>;
+        using CongestionFunction = bacs::unique_function<void(bool)>;
 
-        StreamClient(Socket&& sock, std::function<bool(bacs::shared_buffer&)> onHandle = {}, std::function<void(const boost::system::error_code&)> onDeath = {})
-            : _state(std::make_shared<SharedStateBlock>(std::move(sock), onHandle, onDeath))
+        StreamClient(Socket&& sock, HandleFunction onHandle = {}, DeathFunction onDeath = {})
+            : _state(std::make_shared<SharedStateBlock>(std::move(sock), std::move(onHandle), std::move(onDeath)))
         {
         }
 
@@ -38,13 +70,24 @@ namespace gspp
             return _state->socket.remote_endpoint();
         }
 
+        /// @brief Starts reading frames. Built as C++20 this runs as a coroutine, otherwise as a callback chain;
+        /// define GSPP_NO_COROUTINES to force the latter.
         void StartReceiveLoop()
         {
             // We're copying here to capture the shared ptr in the handler lambda in order to prolong its lifetime until at least its invocation, this is important
             auto state = _state;
 
-            bacs::async_read_sp_loop<SPTraits>(state->socket,
-                [state](const boost::system::error_code& ec, std::size_t bytes_read, bacs::shared_buffer buffer)
+#if defined(BOOST_ASIO_HAS_CO_AWAIT) && !defined(GSPP_NO_COROUTINES)
+            boost::asio::co_spawn(state->socket.get_executor(), ReceiveLoop(state),
+                [](std::exception_ptr e)
+                {
+                    // Only what on_death itself throws gets here; it leaves through io_context::run()
+                    if (e)
+                        std::rethrow_exception(e);
+                });
+#else
+            bacs::async_read_sp_loop<SPTraits>(state->socket, state->read_pool, bacs::bind_allocator(state->handler_allocator(),
+                [state](const boost::system::error_code& ec, std::size_t, bacs::shared_buffer buffer)
                 {
                     if (ec.failed())
                     {
@@ -53,24 +96,89 @@ namespace gspp
 
                         return false;
                     }
-                    else
+
+                    try
                     {
-                        return (state->on_handle) ? state->on_handle(buffer) : true;
+                        return state->HandleFrame(std::move(buffer));
                     }
-                });
+                    catch (const std::exception& e)
+                    {
+                        if (state->on_death)
+                            state->on_death(ErrorOf(e));
+
+                        return false;
+                    }
+                }));
+#endif
         }
 
+        /// @return False if the backpressure policy refused the message. Always true with an outgoing impairment set.
         template<class Packet>
-        void Send(const Packet& packet)
+        bool Send(const Packet& packet)
         {
-            auto ws = PacketSerializer<Packet>::template Serialize<plakpacs::write_stream>(packet);
+            return Send(PreparedPacket::Make(packet));
+        }
 
+        /// @brief Queues an already serialized packet. The queue shares its bytes instead of copying them.
+        bool Send(const PreparedPacket& packet)
+        {
+            if (_state->outgoing_impairment)
+            {
+                auto state = _state;
+
+                _state->outgoing_impairment->Submit(packet.size(),
+                    [state, packet]
+                    {
+                        state->Enqueue(packet.buffer());
+                    }, true);
+
+                return true;
+            }
+
+            return _state->Enqueue(packet.buffer());
+        }
+
+        /// @brief Bounds the write queue.
+        /// @param onCongestion Called with true when the queue goes over a high watermark and with false once it drains to the low ones.
+        /// It runs on whichever thread caused the change, outside of the queue lock, so it may send.
+        void SetBackpressure(BackpressureConfig config, CongestionFunction onCongestion = {})
+        {
             std::lock_guard lg{ _state->write_lock };
-            _state->write_queue.push(ws.bytes());
 
-            // If it's empty, restart the operation
-            if (_state->write_queue.size() == 1)
-                _state->WriteAsync(_state->write_queue.front());
+            _state->backpressure = config;
+            _state->on_congestion = onCongestion ? std::make_shared<CongestionFunction>(std::move(onCongestion)) : nullptr;
+        }
+
+        bool congested() const
+        {
+            return _state->congested;
+        }
+
+        /// @brief Tunes the socket, see bacs::socket_profile for the presets. Meant to be called right after connecting or accepting.
+        /// @return The first option the socket refused. The others are applied regardless
+        boost::system::error_code SetSocketProfile(const bacs::socket_profile& profile)
+        {
+            std::lock_guard lg{ _state->write_lock };
+
+            _state->cork_while_queued = profile.cork_while_queued;
+            return bacs::apply_socket_profile(_state->socket, profile);
+        }
+
+        /// @brief Routes sends and/or receives through simulated network links. Meant for testing; set it up before any traffic flows.
+        void SetImpairment(std::shared_ptr<NetworkImpairment> outgoing, std::shared_ptr<NetworkImpairment> incoming = nullptr)
+        {
+            _state->outgoing_impairment = std::move(outgoing);
+            _state->incoming_impairment = std::move(incoming);
+        }
+
+        /// @brief The write queue's current depth and high-water mark, in messages. Always zero unless GSPP_ENABLE_METRICS is defined.
+        metrics::QueueMetrics GetQueueMetrics() const
+        {
+#if defined(GSPP_ENABLE_METRICS)
+            return _state->queue_gauge.Get();
+#else
+            return {};
+#endif
         }
 
         void CloseSocket()
@@ -89,20 +197,74 @@ namespace gspp
         }
 
     private:
+        // A read and a write in flight, each holding its operation and its size prefix
+        static constexpr std::size_t HandlerMemoryBlocks = 6;
+        // A batched write's operation carries the array of up to 64 buffers asio prepares for it, which outgrows the default block
+        static constexpr std::size_t HandlerBlockSize = 1024;
+
+        // Frames up to this size are read into pooled buffers. A handler rarely keeps more than a few, so few are kept for reuse
+        static constexpr std::size_t PooledFrameSize = 4096;
+        static constexpr std::size_t PooledFrames = 8;
+
+        // Two buffers per message keeps a batch within the 64 buffers asio hands to a single writev
+        static constexpr std::size_t MaxBatchMessages = 32;
+
+        // asio copies the buffer sequence into the operation, so it gets this view rather than the vector itself
+        struct BatchView
+        {
+            const boost::asio::const_buffer* first;
+            const boost::asio::const_buffer* last;
+
+            const boost::asio::const_buffer* begin() const
+            {
+                return first;
+            }
+
+            const boost::asio::const_buffer* end() const
+            {
+                return last;
+            }
+        };
+
         struct SharedStateBlock : std::enable_shared_from_this<SharedStateBlock>
         {
             Socket socket;
 
-            std::queue<std::vector<uint8_t>> write_queue;
+            std::deque<bacs::shared_buffer> write_queue;
+            std::size_t queued_bytes = 0;
             std::mutex write_lock;
 
-            std::function<bool(bacs::shared_buffer&)> on_handle;
-            std::function<void(const boost::system::error_code&)> on_death;
+            // The first `writing` messages of the queue are the batch being written. Its size prefixes and buffer list
+            // are kept here so that starting a batch doesn't allocate once they've grown
+            std::size_t writing = 0;
+            std::vector<typename SPTraits::size_type> batch_prefixes;
+            std::vector<boost::asio::const_buffer> batch_buffers;
+
+            bool cork_while_queued = false;
+            bool corked = false;
+
+            BackpressureConfig backpressure;
+            // Shared so that a callback copied out under the lock survives being replaced while it runs
+            std::shared_ptr<CongestionFunction> on_congestion;
+            std::atomic<bool> congested = false;
+            bool disconnected = false;
+            GSPP_METRIC_QUEUE_GAUGE(queue_gauge);
+
+            HandleFunction on_handle;
+            DeathFunction on_death;
+
+            std::shared_ptr<NetworkImpairment> outgoing_impairment;
+            std::shared_ptr<NetworkImpairment> incoming_impairment;
+            std::atomic<bool> receive_stopped = false;
+
+            // Backs the read and the write chain's handlers, so a running connection doesn't go to the global heap for them
+            bacs::handler_memory::pointer handler_memory = bacs::handler_memory::create(HandlerMemoryBlocks, HandlerBlockSize);
+            bacs::buffer_pool read_pool{ PooledFrameSize, PooledFrames };
 
             bool shutdown = false;
 
-            SharedStateBlock(Socket&& rvsocket, std::function<bool(bacs::shared_buffer&)> onHandle, std::function<void(const boost::system::error_code&)> onDeath)
-                : socket(std::move(rvsocket)), on_handle(onHandle), on_death(onDeath)
+            SharedStateBlock(Socket&& rvsocket, HandleFunction onHandle, DeathFunction onDeath)
+                : socket(std::move(rvsocket)), on_handle(std::move(onHandle)), on_death(std::move(onDeath))
             {}
 
             ~SharedStateBlock()
@@ -110,34 +272,238 @@ namespace gspp
                 socket.close();
             }
 
-            void WriteAsync(const std::vector<uint8_t>& data)
+            bacs::handler_allocator<> handler_allocator() const
+            {
+                return bacs::handler_allocator<>(*handler_memory);
+            }
+
+            /// @return Whether to keep receiving
+            bool HandleFrame(bacs::shared_buffer buffer)
+            {
+                GSPP_METRIC_TRAFFIC(Stream, In, buffer.size());
+
+                if (incoming_impairment)
+                {
+                    auto state = this->shared_from_this();
+
+                    // The handler's verdict arrives late here, so it stops the loop on the next frame instead
+                    incoming_impairment->Submit(buffer.size(),
+                        [state, buffer]() mutable
+                        {
+                            if (!state->receive_stopped && state->on_handle && !state->on_handle(buffer))
+                                state->receive_stopped = true;
+                        }, true);
+
+                    return !receive_stopped;
+                }
+                else
+                {
+                    return (on_handle) ? on_handle(buffer) : true;
+                }
+            }
+
+            bool AboveHighWater(std::size_t messages, std::size_t bytes) const
+            {
+                return (backpressure.high_water_messages && messages > backpressure.high_water_messages) ||
+                       (backpressure.high_water_bytes && bytes > backpressure.high_water_bytes);
+            }
+
+            bool AboveLowWater() const
+            {
+                return write_queue.size() > backpressure.low_water_messages || queued_bytes > backpressure.low_water_bytes;
+            }
+
+            bool Enqueue(const bacs::shared_buffer& bytes)
+            {
+                bool queued = true;
+                std::shared_ptr<CongestionFunction> onCongestion;
+
+                {
+                    std::lock_guard lg{ write_lock };
+
+                    if (disconnected)
+                        return false;
+
+                    auto messages = write_queue.size() + 1;
+                    auto total = queued_bytes + bytes.size();
+
+                    if (AboveHighWater(messages, total))
+                    {
+                        if (!congested.exchange(true))
+                            onCongestion = on_congestion;
+
+                        switch (backpressure.policy)
+                        {
+                        case BackpressurePolicy::Signal:
+                            break;
+
+                        case BackpressurePolicy::DropNewest:
+                            queued = false;
+                            break;
+
+                        case BackpressurePolicy::DropOldest:
+                            if (write_queue.size() > writing)
+                            {
+                                // The batch at the front is already being written, so dropping starts right after it
+                                auto first = write_queue.begin() + writing;
+                                auto last = first;
+
+                                for (; last != write_queue.end() && AboveHighWater(messages, total); ++last)
+                                {
+                                    messages--;
+                                    total -= last->size();
+                                    queued_bytes -= last->size();
+                                }
+
+                                write_queue.erase(first, last);
+                            }
+
+                            queued = !AboveHighWater(messages, total);
+                            break;
+
+                        case BackpressurePolicy::Disconnect:
+                        {
+                            queued = false;
+                            disconnected = true;
+
+                            boost::system::error_code ec;
+                            socket.shutdown(socket.shutdown_both, ec);
+                            socket.close(ec);
+                            break;
+                        }
+                        }
+                    }
+
+                    if (queued)
+                    {
+                        write_queue.push_back(bytes);
+                        queued_bytes += bytes.size();
+                        GSPP_METRIC_QUEUE_DEPTH(queue_gauge, write_queue.size());
+
+                        // If nothing is being written, restart the operation
+                        if (!writing)
+                            WriteAsync();
+                    }
+                }
+
+                if (onCongestion)
+                    (*onCongestion)(true);
+
+                return queued;
+            }
+
+            /// @brief Writes everything queued, up to MaxBatchMessages, in one gathered write. Called under the write lock
+            /// with a non-empty queue and no write in flight.
+            void WriteAsync()
             {
                 // Same deal as in the ctor
                 auto state = this->shared_from_this();
 
-                bacs::async_write_sp<SPTraits>(
-                    state->socket, data,
-                    [state](const boost::system::error_code&, std::size_t)
+                writing = std::min(write_queue.size(), MaxBatchMessages);
+                batch_prefixes.resize(writing);
+                batch_buffers.clear();
+
+                std::size_t payload_bytes = 0;
+
+                for (std::size_t i = 0; i < writing; i++)
+                {
+                    auto& message = write_queue[i];
+
+                    batch_prefixes[i] = (typename SPTraits::size_type)message.size();
+                    SPTraits::out(batch_prefixes[i]);
+
+                    batch_buffers.emplace_back(&batch_prefixes[i], sizeof(batch_prefixes[i]));
+                    batch_buffers.emplace_back(message.data(), message.size());
+                    payload_bytes += message.size();
+                }
+
+                if (cork_while_queued && !corked)
+                {
+                    boost::system::error_code ec;
+                    bacs::set_cork(socket, true, ec);
+                    corked = !ec.failed();
+                }
+
+                boost::asio::async_write(
+                    socket, BatchView{ batch_buffers.data(), batch_buffers.data() + batch_buffers.size() }, bacs::bind_allocator(handler_allocator(),
+                    [state, payload_bytes, messages = writing](const boost::system::error_code& error, std::size_t)
                     {
-                        std::lock_guard lg{ state->write_lock };
+                        if (!error.failed())
+                            GSPP_METRIC_TRAFFIC_BATCH(Stream, Out, payload_bytes, messages);
 
-                        state->write_queue.pop();
+                        std::shared_ptr<CongestionFunction> onRelieved;
 
-                        if (state->shutdown)
                         {
-                            boost::system::error_code ec;
-                            state->socket.shutdown(state->socket.shutdown_both, ec);
+                            std::lock_guard lg{ state->write_lock };
+
+                            for (; state->writing; state->writing--)
+                            {
+                                state->queued_bytes -= state->write_queue.front().size();
+                                state->write_queue.pop_front();
+                            }
+
+                            GSPP_METRIC_QUEUE_DEPTH(state->queue_gauge, state->write_queue.size());
 
-                            state->socket.close();
+                            if (state->congested && !state->AboveLowWater() && state->congested.exchange(false))
+                                onRelieved = state->on_congestion;
+
+                            if (state->shutdown)
+                            {
+                                boost::system::error_code ec;
+                                state->socket.shutdown(state->socket.shutdown_both, ec);
+
+                                state->socket.close();
+                            }
+
+                            if (!state->write_queue.empty())
+                            {
+                                state->WriteAsync();
+                            }
+                            else if (state->corked)
+                            {
+                                // Drained: let the tail of the last batch go out now
+                                boost::system::error_code ec;
+                                bacs::set_cork(state->socket, false, ec);
+                                state->corked = false;
+                            }
                         }
 
-                        if (!state->write_queue.empty())
-                            state->WriteAsync(state->write_queue.front());
-                    }
+                        if (onRelieved)
+                            (*onRelieved)(false);
+                    })
                 );
             }
         };
 
+#if defined(BOOST_ASIO_HAS_CO_AWAIT) && !defined(GSPP_NO_COROUTINES)
+        static boost::asio::awaitable<void> ReceiveLoop(std::shared_ptr<SharedStateBlock> state)
+        {
+            try
+            {
+                while (state->HandleFrame(co_await bacs::read_frame<SPTraits>(state->socket, state->read_pool)))
+                {}
+            }
+            catch (const std::exception& e)
+            {
+                if (state->on_death)
+                    state->on_death(ErrorOf(e));
+            }
+        }
+#endif
+
+        /// @brief What a connection dies of when reading or handling a frame throws. A handler rejecting a malformed
+        /// frame by throwing counts as a protocol error.
+        static boost::system::error_code ErrorOf(const std::exception& e)
+        {
+            if (auto system = dynamic_cast<const boost::system::system_error*>(&e))
+                return system->code();
+
+            if (dynamic_cast<const std::bad_alloc*>(&e))
+                return boost::asio::error::no_memory;
+
+            return boost::system::errc::make_error_code(boost::system::errc::protocol_error);
+        }
+
         std::shared_ptr<SharedStateBlock> _state;
     };
 }
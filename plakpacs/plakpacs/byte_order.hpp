@@ -0,0 +1,168 @@
+//
+//  byte_order.hpp
+//  plakpacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+namespace plakpacs
+{
+    /// @brief Whether this machine stores numbers least significant byte first.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    inline constexpr bool host_is_little_endian = false;
+#else
+    inline constexpr bool host_is_little_endian = true;
+#endif
+
+    /// @brief Byte order policies for plakpacs streams. Numbers and enums are stored in the stream's order; anything
+    /// else a stream copies as a whole, like a struct without reflection, stays as it is in memory.
+    struct little_endian
+    {
+        static constexpr bool swaps = !host_is_little_endian;
+    };
+
+    struct big_endian
+    {
+        static constexpr bool swaps = host_is_little_endian;
+    };
+
+    /// @brief The host's own order, for bytes that never leave the machine.
+    struct native_endian
+    {
+        static constexpr bool swaps = false;
+    };
+
+    namespace detail
+    {
+        template<std::size_t N>
+        struct uint_of_size;
+
+        template<>
+        struct uint_of_size<2>
+        {
+            using type = std::uint16_t;
+        };
+
+        template<>
+        struct uint_of_size<4>
+        {
+            using type = std::uint32_t;
+        };
+
+        template<>
+        struct uint_of_size<8>
+        {
+            using type = std::uint64_t;
+        };
+
+        /// @brief Numbers and enums of 2, 4 or 8 bytes; the only values whose order depends on the host.
+        template<class T>
+        struct is_byte_swappable
+        : std::bool_constant<(std::is_arithmetic_v<T> || std::is_enum_v<T>) && (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>
+        {};
+
+        inline std::uint16_t byteswap(std::uint16_t value)
+        {
+#if defined(_MSC_VER)
+            return _byteswap_ushort(value);
+#else
+            return __builtin_bswap16(value);
+#endif
+        }
+
+        inline std::uint32_t byteswap(std::uint32_t value)
+        {
+#if defined(_MSC_VER)
+            return _byteswap_ulong(value);
+#else
+            return __builtin_bswap32(value);
+#endif
+        }
+
+        inline std::uint64_t byteswap(std::uint64_t value)
+        {
+#if defined(_MSC_VER)
+            return _byteswap_uint64(value);
+#else
+            return __builtin_bswap64(value);
+#endif
+        }
+    }
+
+    /// @brief Copies a value to any address, aligned or not, in the given byte order.
+    template<class Order, class T>
+    void store(void* to, const T& value)
+    {
+        if constexpr(Order::swaps && detail::is_byte_swappable<T>::value)
+        {
+            typename detail::uint_of_size<sizeof(T)>::type bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            bits = detail::byteswap(bits);
+            std::memcpy(to, &bits, sizeof(T));
+        }
+        else
+        {
+            std::memcpy(to, &value, sizeof(T));
+        }
+    }
+
+    /// @brief Copies a value in the given byte order from any address, aligned or not.
+    template<class Order, class T>
+    void load(const void* from, T& value)
+    {
+        if constexpr(Order::swaps && detail::is_byte_swappable<T>::value)
+        {
+            typename detail::uint_of_size<sizeof(T)>::type bits;
+            std::memcpy(&bits, from, sizeof(T));
+            bits = detail::byteswap(bits);
+            std::memcpy(&value, &bits, sizeof(T));
+        }
+        else
+        {
+            std::memcpy(&value, from, sizeof(T));
+        }
+    }
+
+    /// @brief store() for a whole array. A single copy when the order matches the host's, otherwise a plain loop
+    /// that compilers turn into vector byte shuffles.
+    template<class Order, class T>
+    void store_array(void* to, const T* values, std::size_t count)
+    {
+        if constexpr(Order::swaps && detail::is_byte_swappable<T>::value)
+        {
+            auto bytes = static_cast<unsigned char*>(to);
+            for(std::size_t i = 0; i < count; i++)
+                store<Order>(bytes + i * sizeof(T), values[i]);
+        }
+        else if(count > 0)
+        {
+            std::memcpy(to, values, count * sizeof(T));
+        }
+    }
+
+    /// @brief load() for a whole array, the same way as store_array().
+    template<class Order, class T>
+    void load_array(const void* from, T* values, std::size_t count)
+    {
+        if constexpr(Order::swaps && detail::is_byte_swappable<T>::value)
+        {
+            auto bytes = static_cast<const unsigned char*>(from);
+            for(std::size_t i = 0; i < count; i++)
+                load<Order>(bytes + i * sizeof(T), values[i]);
+        }
+        else if(count > 0)
+        {
+            std::memcpy(values, from, count * sizeof(T));
+        }
+    }
+}
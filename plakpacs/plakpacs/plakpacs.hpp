@@ -8,9 +8,12 @@
 
 #pragma once
 #include <bpacs/bpacs.hpp>
+#include <bpacs/arena.hpp>
+#include "byte_order.hpp"
 #include <vector>
 #include <list>
 #include <array>
+#include <iterator>
 #include <string>
 #include <optional>
 #include <stdexcept>
@@ -27,7 +30,7 @@ namespace plakpacs
         using is_sp_container = void;
         
         /// @brief Forwards non-initializer-list construction to the container.
-        template<class... Args>
+        template<class... Args, std::enable_if_t<std::is_constructible_v<T, Args&&...>, int> = 0>
         sp_container(Args&&... args)
         : T(std::forward<Args>(args)...)
         {}
@@ -66,6 +69,27 @@ namespace plakpacs
     using sp_string = sp_basic_string<char>;
     using sp_wstring = sp_basic_string<wchar_t>;
 
+    /// @brief Containers backed by bpacs::arena_allocator. Whatever is read inside a bpacs::arena_scope, including
+    /// nested containers, allocates from its arena and is freed all at once with it; outside of one they use the heap.
+    namespace pmr
+    {
+        template<class T>
+        using vector = std::vector<T, bpacs::arena_allocator<T>>;
+
+        template<class T>
+        using list = std::list<T, bpacs::arena_allocator<T>>;
+
+        using string = std::basic_string<char, std::char_traits<char>, bpacs::arena_allocator<char>>;
+
+        template<class T>
+        using sp_vector = sp_container<vector<T>>;
+
+        template<class T>
+        using sp_list = sp_container<list<T>>;
+
+        using sp_string = sp_container<string>;
+    }
+
     /// @brief A simple SFINAE check whether a type is an SP container.
     /// @tparam T The type to check
     template<class T, typename = std::void_t<>>
@@ -79,6 +103,8 @@ namespace plakpacs
     {};
     
     /// @brief A helper class to put constraints on a type. Provides a method to check if the current instance satisfies the constraints.
+    /// Constraints provide check(const T&), and may also provide check_size(std::size_t) or check_raw<Order, V>(const void*, std::size_t)
+    /// so that size-prefixed containers can be turned away on their size prefix or raw elements, before they're read (see validators.hpp).
     /// @tparam T The constrained type
     /// @tparam Cs The constraints to apply (may be empty)
     template<class T, class... Cs>
@@ -86,7 +112,7 @@ namespace plakpacs
     {
     public:
         /// @brief Forwards non-initializer-list construction to the constrained type.
-        template<class... Args>
+        template<class... Args, std::enable_if_t<std::is_constructible_v<T, Args&&...>, int> = 0>
         constrained(Args&&... args)
         : T(std::forward<Args>(args)...)
         {}
@@ -117,6 +143,12 @@ namespace plakpacs
             auto result = Comparison{}(std::size(container), N);
             return result;
         }
+
+        /// @brief The same check on a size prefix, before the container is read.
+        static bool check_size(std::size_t size)
+        {
+            return Comparison{}(size, N);
+        }
     };
     
     /// @brief A constraint for the minimum size of a container.
@@ -154,6 +186,11 @@ namespace plakpacs
         {
             return min_constraint::check(container) && max_constraint::check(container);
         }
+
+        static bool check_size(std::size_t size)
+        {
+            return min_constraint::check_size(size) && max_constraint::check_size(size);
+        }
     };
     
     /// @brief A basic "binary walker" type with static methods to read and write a value of a certain type from a stream. This default implementation forwards both write and read operations to the stream; to define more complex behavior, specialize this template with your type.
@@ -290,19 +327,21 @@ namespace plakpacs
     };
     
     
-    /// @brief Specializes binary_walker for C++ strings. Prevents them being treated as containers and written character-by-character which is obviously slow.
+    /// @brief Specializes binary_walker for C++ strings, whatever their allocator. Prevents them being treated as containers and written character-by-character which is obviously slow.
     /// @tparam Stream The stream type to use
-    template<class Stream>
-    struct binary_walker<Stream, std::string>
+    template<class Stream, class Traits, class Alloc>
+    struct binary_walker<Stream, std::basic_string<char, Traits, Alloc>>
     {
+        using string_type = std::basic_string<char, Traits, Alloc>;
+
         /// @brief Writes the string "as-is" to the stream.
-        static void write(Stream& stream, const std::string& string)
+        static void write(Stream& stream, const string_type& string)
         {
             stream.write(string.begin(), string.end());
             stream.write('\0');
         }
         
-        static void read(Stream& stream, std::string& value)
+        static void read(Stream& stream, string_type& value)
         {
             while(auto c = stream.template read<char>())
             {
@@ -330,6 +369,116 @@ namespace plakpacs
         T* _container;
     };
     
+    /// @brief Containers whose elements can be read in place at their end, without a temporary to copy from.
+    template<class T, typename = std::void_t<>>
+    struct is_emplaceable_container : std::false_type
+    {};
+
+    template<class T>
+    struct is_emplaceable_container<T, std::void_t<decltype(std::declval<T&>().emplace_back())>>
+    : std::is_same<decltype(std::declval<T&>().emplace_back()), typename T::value_type&>
+    {};
+
+    /// @brief Containers of numbers laid out in one block, which streams can copy as a whole.
+    template<class T, typename = std::void_t<>>
+    struct is_contiguous_number_container : std::false_type
+    {};
+
+    template<class T>
+    struct is_contiguous_number_container<T, std::void_t<typename T::value_type, decltype(std::data(std::declval<T&>()))>>
+    : std::bool_constant<std::is_same_v<decltype(std::data(std::declval<T&>())), typename T::value_type*> &&
+                         (std::is_arithmetic_v<typename T::value_type> || std::is_enum_v<typename T::value_type>)>
+    {};
+
+    template<class T, typename = std::void_t<>>
+    struct is_resizable_container : std::false_type
+    {};
+
+    template<class T>
+    struct is_resizable_container<T, std::void_t<decltype(std::declval<T&>().resize(std::size_t{}))>> : std::true_type
+    {};
+
+    /// @brief Streams with write_array(const T* values, std::size_t count).
+    template<class Stream, class T, typename = std::void_t<>>
+    struct has_array_write : std::false_type
+    {};
+
+    template<class Stream, class T>
+    struct has_array_write<Stream, T, std::void_t<decltype(std::declval<Stream&>().write_array(std::declval<const T*>(), std::size_t{}))>>
+    : std::true_type
+    {};
+
+    /// @brief Streams with read_array(T* values, std::size_t count) and can_read_num(std::size_t num).
+    template<class Stream, class T, typename = std::void_t<>>
+    struct has_array_read : std::false_type
+    {};
+
+    template<class Stream, class T>
+    struct has_array_read<Stream, T, std::void_t<decltype(std::declval<Stream&>().read_array(std::declval<T*>(), std::size_t{})),
+                                                 decltype(std::declval<Stream&>().can_read_num(std::size_t{}))>>
+    : std::true_type
+    {};
+
+    /// @brief The byte order a stream stores numbers in; little_endian for streams that don't say.
+    template<class Stream, typename = std::void_t<>>
+    struct stream_byte_order
+    {
+        using type = little_endian;
+    };
+
+    template<class Stream>
+    struct stream_byte_order<Stream, std::void_t<typename Stream::byte_order>>
+    {
+        using type = typename Stream::byte_order;
+    };
+
+    /// @brief Streams that expose the bytes they haven't read yet through bytes() and position(), like read_stream.
+    template<class Stream, typename = std::void_t<>>
+    struct has_raw_view : std::false_type
+    {};
+
+    template<class Stream>
+    struct has_raw_view<Stream, std::void_t<decltype(std::data(std::declval<const Stream&>().bytes())),
+                                            decltype(std::declval<const Stream&>().position())>>
+    : std::true_type
+    {};
+
+    /// @brief Constraints with check_size(std::size_t size), which decide on a container's size alone.
+    template<class C, typename = std::void_t<>>
+    struct has_size_check : std::false_type
+    {};
+
+    template<class C>
+    struct has_size_check<C, std::void_t<decltype(C::check_size(std::size_t{}))>> : std::true_type
+    {};
+
+    /// @brief Constraints with check_raw<Order, V>(const void* bytes, std::size_t count), which decide on the encoded elements
+    /// of a container still in the stream, stored in the given byte order.
+    template<class C, class Order, class V, typename = std::void_t<>>
+    struct has_raw_check : std::false_type
+    {};
+
+    template<class C, class Order, class V>
+    struct has_raw_check<C, Order, V, std::void_t<decltype(C::template check_raw<Order, V>(std::declval<const void*>(), std::size_t{}))>>
+    : std::true_type
+    {};
+
+    template<class T, typename = std::void_t<>>
+    struct has_tuple_size : std::false_type
+    {};
+
+    template<class T>
+    struct has_tuple_size<T, std::void_t<decltype(std::tuple_size<T>::value)>> : std::true_type
+    {};
+
+    template<class T>
+    struct is_char_string : std::false_type
+    {};
+
+    template<class Traits, class Alloc>
+    struct is_char_string<std::basic_string<char, Traits, Alloc>> : std::true_type
+    {};
+
     /// @brief A container_appender specialization for fixed-sized containers.
     template<class T>
     class container_appender<T, std::void_t<decltype(std::tuple_size<T>::value)>>
@@ -357,23 +506,33 @@ namespace plakpacs
     template<class Stream, class T>
     struct binary_walker<Stream, T, std::void_t<decltype(std::begin(std::declval<T>())), decltype(std::end(std::declval<T>()))>>
     {
-        /// @brief Writes the container's elements to the stream one-by-one.
+        /// @brief Writes the container's elements to the stream one-by-one, or all at once if they're numbers stored in one block.
         static void write(Stream& stream, const T& container)
         {
-            for(auto& value : container)
-                serializer::write(stream, value);
+            if constexpr(is_contiguous_number_container<T>::value && has_array_write<Stream, typename T::value_type>::value)
+            {
+                stream.write_array(std::data(container), std::size(container));
+            }
+            else
+            {
+                for(auto& value : container)
+                    serializer::write(stream, value);
+            }
         }
         
         // The template parameter constrains reading non-SP containers to those whose size is known at compile-time
         static void read(Stream& stream, T& container)
         {
             constexpr auto N = std::tuple_size<T>::value;
-            container_appender appender{container};
-            for(size_t i = 0; i < N; i++)
+
+            if constexpr(is_contiguous_number_container<T>::value && has_array_read<Stream, typename T::value_type>::value)
+            {
+                stream.read_array(std::data(container), N);
+            }
+            else
             {
-                typename T::value_type value;
-                serializer::read(stream, value);
-                appender.append(value);
+                for(size_t i = 0; i < N; i++)
+                    serializer::read(stream, container[i]);
             }
         }
     };
@@ -397,17 +556,38 @@ namespace plakpacs
             if (size > 65536)
                 throw std::runtime_error("plakpacs::binary_walker<Stream, sp_container<T>>.read() => Invalid container size...");
 
-            container_appender appender{container};
-            for(size_t i = 0; i < size; i++)
+            // Read straight into the container where possible: elements built elsewhere and copied in would neither
+            // be cheap nor share the container's allocator
+            if constexpr(is_contiguous_number_container<T>::value && is_resizable_container<T>::value &&
+                         has_array_read<Stream, typename T::value_type>::value)
+            {
+                // Check first, so that a bogus size can't make us allocate
+                if(!stream.can_read_num(size * sizeof(typename T::value_type)))
+                    throw std::runtime_error("plakpacs::binary_walker<Stream, sp_container<T>>.read() => Can't read past the end of the stream");
+
+                auto offset = std::size(container);
+                container.resize(offset + size);
+                stream.read_array(std::data(container) + offset, size);
+            }
+            else if constexpr(is_emplaceable_container<T>::value)
+            {
+                for(size_t i = 0; i < size; i++)
+                    serializer::read(stream, container.emplace_back());
+            }
+            else
             {
-                typename T::value_type value;
-                serializer::read(stream, value);
-                appender.append(value);
+                container_appender appender{container};
+                for(size_t i = 0; i < size; i++)
+                {
+                    typename T::value_type value;
+                    serializer::read(stream, value);
+                    appender.append(value);
+                }
             }
 
             // VERY BAD HACK: Silently ignore the last character of any std::string SP containers. They were not read at all before.
             // This horrendous bug has been sitting UNNOTICED for almost precisely one year, in theory preventing the reading of ANY sp_strings.
-            if (std::is_same_v<T, std::string>)
+            if (is_char_string<T>::value)
                 (void) serializer::read<char>(stream);
         }
     };
@@ -433,11 +613,7 @@ namespace plakpacs
 
             bool has = stream.template read<bool>();
             if(has)
-            {
-                T value;
-                serializer::read(stream, value);
-                optional = value;
-            }
+                serializer::read(stream, optional.emplace());
         }
     };
     
@@ -451,17 +627,70 @@ namespace plakpacs
         
         static void read(Stream& stream, constrained<T, Cs...>& value)
         {
+            // Constraints that can be decided on the bytes still in the stream are checked before anything is read, so that
+            // hostile sizes and elements are turned away before they're allocated; the rest are checked on the value
+            [[maybe_unused]] std::array<bool, sizeof...(Cs)> checked{ check_early<Cs>(stream)... };
+
             serializer::read<Stream, T>(stream, value);
             
-            if(!value.check_pp_constraints())
+            const auto& obj = static_cast<const T&>(value);
+            [[maybe_unused]] std::size_t index = 0;
+            if(!((checked[index++] || Cs::check(obj)) && ...))
                 throw std::runtime_error("Constraint not satisfied");
         }
+
+    private:
+        /// @return Whether the constraint was checked; throws if it failed
+        template<class C>
+        static bool check_early(Stream& stream)
+        {
+            if constexpr(is_sp_container<T>::value && !has_tuple_size<T>::value && has_raw_view<Stream>::value)
+            {
+                using order = typename stream_byte_order<Stream>::type;
+
+                auto& bytes = stream.bytes();
+                auto data = reinterpret_cast<const unsigned char*>(std::data(bytes));
+                auto available = std::size(bytes) - stream.position();
+
+                if(available < sizeof(std::uint32_t))
+                    return false;
+
+                std::uint32_t size;
+                load<order>(data + stream.position(), size);
+
+                if constexpr(has_size_check<C>::value)
+                {
+                    if(!C::check_size(size))
+                        throw std::runtime_error("Constraint not satisfied");
+
+                    return true;
+                }
+                else if constexpr(is_contiguous_number_container<T>::value && has_raw_check<C, order, typename T::value_type>::value)
+                {
+                    // Leave short input to the read, which fails on it anyway
+                    if((available - sizeof(std::uint32_t)) / sizeof(typename T::value_type) < size)
+                        return false;
+
+                    if(!C::template check_raw<order, typename T::value_type>(data + stream.position() + sizeof(std::uint32_t), size))
+                        throw std::runtime_error("Constraint not satisfied");
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
     };
     
-    class write_stream
+    /// @brief Writes values into a byte vector.
+    /// @tparam ByteOrder The order to store numbers in: little_endian (the default, which is what every plakpacs peer so far has used), big_endian or native_endian
+    template<class ByteOrder = little_endian>
+    class basic_write_stream
     {
     public:
-        write_stream()
+        using byte_order = ByteOrder;
+
+        basic_write_stream()
         {
             _bytes.reserve(128);
         }
@@ -469,10 +698,20 @@ namespace plakpacs
         template<class T>
         void write(const T& value)
         {
-            std::array<uint8_t, sizeof(T)> vbytes;
-            *(T*) vbytes.data() = value;
-            
-            _bytes.insert(_bytes.end(), vbytes.begin(), vbytes.end());
+            static_assert(std::is_trivially_copyable_v<T>, "plakpacs::write_stream can only copy out trivially copyable values");
+
+            auto size = _bytes.size();
+            _bytes.resize(size + sizeof(T));
+            store<ByteOrder>(_bytes.data() + size, value);
+        }
+
+        /// @brief Writes count values in one go, the same as writing them one by one.
+        template<class T>
+        void write_array(const T* values, std::size_t count)
+        {
+            auto size = _bytes.size();
+            _bytes.resize(size + count * sizeof(T));
+            store_array<ByteOrder>(_bytes.data() + size, values, count);
         }
         
         template<class Iter>
@@ -500,16 +739,23 @@ namespace plakpacs
         std::vector<uint8_t> _bytes;
     };
     
-    class read_stream
+    using write_stream = basic_write_stream<>;
+    
+    /// @brief Reads values from its own copy of some bytes.
+    /// @tparam ByteOrder The order numbers are stored in, as for basic_write_stream
+    template<class ByteOrder = little_endian>
+    class basic_read_stream
     {
     public:
+        using byte_order = ByteOrder;
+
         template<class Iter>
-        read_stream(Iter begin, Iter end)
+        basic_read_stream(Iter begin, Iter end)
         : _bytes(begin, end)
         {}
         
         template<class Container>
-        read_stream(const Container& container)
+        basic_read_stream(const Container& container)
         : _bytes(std::begin(container), std::end(container))
         {}
         
@@ -522,12 +768,25 @@ namespace plakpacs
                 return;
             }
 
+            static_assert(std::is_trivially_copyable_v<T>, "plakpacs::read_stream can only copy in trivially copyable values");
+
             if (!can_read_num(sizeof(T)))
                 throw std::runtime_error("plakpacs::read_stream.read<T>() => Can't read past the end of the stream");
 
-            value = *(T*) (_bytes.data() + _position);
+            load<ByteOrder>(_bytes.data() + _position, value);
             _position += sizeof(T);
         }
+
+        /// @brief Reads count values in one go, the same as reading them one by one.
+        template<class T>
+        void read_array(T* values, std::size_t count)
+        {
+            if (!can_read_num(count * sizeof(T)))
+                throw std::runtime_error("plakpacs::read_stream.read_array<T>() => Can't read past the end of the stream");
+
+            load_array<ByteOrder>(_bytes.data() + _position, values, count);
+            _position += count * sizeof(T);
+        }
         
         template<class T>
         T read()
@@ -537,9 +796,18 @@ namespace plakpacs
             return value;
         }
 
+        /// @brief Moves past bytes that were looked at in place through bytes() and position().
+        void skip(std::size_t num)
+        {
+            if (num > _bytes.size() - _position)
+                throw std::runtime_error("plakpacs::read_stream.skip() => Can't skip past the end of the stream");
+
+            _position += num;
+        }
+
         bool can_read_num(std::size_t num) const
         {
-            return _position <= _bytes.size() - num;
+            return num <= _bytes.size() - _position;
         }
         
         bool can_read() const
@@ -561,4 +829,6 @@ namespace plakpacs
         std::vector<uint8_t> _bytes;
         size_t _position = 0;
     };
+
+    using read_stream = basic_read_stream<>;
 }
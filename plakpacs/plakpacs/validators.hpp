@@ -0,0 +1,179 @@
+//
+//  validators.hpp
+//  plakpacs
+//
+//  Created on 18.10.2026.
+//
+
+#pragma once
+#include "byte_order.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+namespace plakpacs
+{
+    namespace detail
+    {
+        template<class V, class B>
+        constexpr bool bound_fits(B bound)
+        {
+            if constexpr(std::is_floating_point_v<V> || std::is_floating_point_v<B>)
+                return true;
+            else if constexpr(std::is_signed_v<B> && !std::is_signed_v<V>)
+                return bound >= 0 && static_cast<std::make_unsigned_t<B>>(bound) <= std::numeric_limits<V>::max();
+            else if constexpr(!std::is_signed_v<B> && std::is_signed_v<V>)
+                return bound <= static_cast<std::make_unsigned_t<V>>(std::numeric_limits<V>::max());
+            else
+                return bound >= std::numeric_limits<V>::lowest() && bound <= std::numeric_limits<V>::max();
+        }
+
+        inline bool is_valid_utf8(const void* data, std::size_t size)
+        {
+            auto bytes = static_cast<const unsigned char*>(data);
+            std::size_t i = 0;
+
+            while(i < size)
+            {
+                // Skip ASCII 16 bytes at a time
+                while(size - i >= 16)
+                {
+                    std::uint64_t first, second;
+                    std::memcpy(&first, bytes + i, 8);
+                    std::memcpy(&second, bytes + i + 8, 8);
+
+                    if((first | second) & 0x8080808080808080ull)
+                        break;
+
+                    i += 16;
+                }
+
+                if(i == size)
+                    break;
+
+                auto c = bytes[i];
+                if(c < 0x80)
+                {
+                    i++;
+                    continue;
+                }
+
+                std::size_t continuations;
+                std::uint32_t code_point;
+                std::uint32_t min;
+
+                if((c & 0xE0) == 0xC0)
+                {
+                    continuations = 1;
+                    code_point = c & 0x1F;
+                    min = 0x80;
+                }
+                else if((c & 0xF0) == 0xE0)
+                {
+                    continuations = 2;
+                    code_point = c & 0x0F;
+                    min = 0x800;
+                }
+                else if((c & 0xF8) == 0xF0)
+                {
+                    continuations = 3;
+                    code_point = c & 0x07;
+                    min = 0x10000;
+                }
+                else
+                {
+                    return false;
+                }
+
+                if(size - i <= continuations)
+                    return false;
+
+                for(std::size_t k = 1; k <= continuations; k++)
+                {
+                    auto b = bytes[i + k];
+                    if((b & 0xC0) != 0x80)
+                        return false;
+
+                    code_point = (code_point << 6) | (b & 0x3F);
+                }
+
+                // Overlong forms, surrogates and anything past Unicode
+                if(code_point < min || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+                    return false;
+
+                i += continuations + 1;
+            }
+
+            return true;
+        }
+    }
+
+    /// @brief A constraint for every element of a container of numbers to be within [Min, Max].
+    /// Read from a stream, size-prefixed containers are checked on their encoded elements before they're read.
+    /// @tparam Min The smallest value allowed
+    /// @tparam Max The largest value allowed
+    template<auto Min, auto Max>
+    struct element_range
+    {
+        template<class T>
+        static bool check(const T& container)
+        {
+            // No early exit, so that the loop vectorizes
+            bool result = true;
+            for(auto& value : container)
+                result &= in_range(value);
+
+            return result;
+        }
+
+        template<class Order, class V>
+        static bool check_raw(const void* bytes, std::size_t count)
+        {
+            auto data = static_cast<const unsigned char*>(bytes);
+
+            bool result = true;
+            for(std::size_t i = 0; i < count; i++)
+            {
+                V value;
+                load<Order>(data + i * sizeof(V), value);
+                result &= in_range(value);
+            }
+
+            return result;
+        }
+
+    private:
+        template<class V>
+        static bool in_range(V value)
+        {
+            static_assert(std::is_arithmetic_v<V>, "plakpacs::element_range: only works on numbers");
+            static_assert(detail::bound_fits<V>(Min) && detail::bound_fits<V>(Max), "plakpacs::element_range: the bounds don't fit the element type");
+
+            constexpr auto min = static_cast<V>(Min);
+            constexpr auto max = static_cast<V>(Max);
+            return (value >= min) & (value <= max);
+        }
+    };
+
+    /// @brief A constraint for a string to be valid UTF-8: no stray continuation bytes, truncated sequences, overlong forms
+    /// or surrogates. Read from a stream, size-prefixed strings are checked before they're read.
+    struct valid_utf8
+    {
+        template<class T>
+        static bool check(const T& string)
+        {
+            static_assert(sizeof(*std::data(string)) == 1, "plakpacs::valid_utf8: only works on strings of bytes");
+            return detail::is_valid_utf8(std::data(string), std::size(string));
+        }
+
+        template<class Order, class V>
+        static bool check_raw(const void* bytes, std::size_t count)
+        {
+            static_assert(sizeof(V) == 1, "plakpacs::valid_utf8: only works on strings of bytes");
+            return detail::is_valid_utf8(bytes, count);
+        }
+    };
+}